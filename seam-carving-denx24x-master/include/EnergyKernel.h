@@ -0,0 +1,21 @@
+#pragma once
+#include "Image.h"
+
+/**
+ * Returns energy of the pixel: square root of the sum of squared differences
+ * of its neighbours' channels (left and right, up and down, wrapping around
+ * the borders) or the sum itself if squared is set
+ */
+double CalculatePixelEnergy(const Image & image, size_t columnId, size_t rowId, bool squared = false);
+
+/**
+ * Same for the pixel with neighbours at the addresses
+ */
+double CalculatePixelEnergy(const uint8_t * left, const uint8_t * right, const uint8_t * up, const uint8_t * down, bool squared = false);
+
+/**
+ * Writes energy of every pixel of the row to energy[0:W-1], same as
+ * CalculatePixelEnergy() for each of them. Inner pixels are processed
+ * with AVX2 or SSE2 when the CPU has them, in integer arithmetic.
+ */
+void CalculateRowEnergy(const Image & image, size_t rowId, double * energy, bool squared = false);
@@ -1,4 +1,6 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
 struct Image
@@ -14,12 +16,69 @@ struct Image
         int m_blue;
     };
 
+    /**
+     * Bytes per pixel, channels are stored interleaved as R, G, B
+     */
+    static constexpr size_t PixelSize = 3;
+
+    /**
+     * Sequence of pixels laid out with a fixed step in the buffer:
+     * a row (step is PixelSize) or a column (step is the row stride)
+     */
+    class View
+    {
+    public:
+        View(const uint8_t * data, size_t size, size_t step);
+
+        size_t size() const;
+        Pixel operator[](size_t id) const;
+
+    private:
+        const uint8_t * m_data;
+        size_t m_size;
+        size_t m_step;
+    };
+
+    /**
+     * Takes table of columns, table[x][y] is pixel (x, y)
+     */
     Image(std::vector<std::vector<Pixel>> table);
+
+    /**
+     * Creates black image of the size
+     * (an image without rows or columns is empty, like after Crop())
+     */
+    Image(size_t width, size_t height);
+
     Pixel GetPixel(size_t columnId, size_t rowId) const;
+    void SetPixel(size_t columnId, size_t rowId, const Pixel & pixel);
     size_t GetColumnIdNormalized(size_t columnId) const;
     size_t GetRowIdNormalized(size_t rowId) const;
     size_t GetWidth() const;
     size_t GetHeight() const;
 
-    std::vector<std::vector<Pixel>> m_table;
-};
\ No newline at end of file
+    /**
+     * Distance between starts of adjacent rows in bytes
+     */
+    size_t GetStride() const;
+
+    View GetRow(size_t rowId) const;
+    View GetColumn(size_t columnId) const;
+
+    /**
+     * Returns packed pixels of the row, stride bytes apart from the next one
+     */
+    const uint8_t * GetRowData(size_t rowId) const;
+    uint8_t * GetRowData(size_t rowId);
+
+    /**
+     * Keeps top left part of the size, the buffer is left as is
+     * (an image without rows or columns becomes empty)
+     */
+    void Crop(size_t width, size_t height);
+
+    size_t m_width = 0;
+    size_t m_height = 0;
+    size_t m_stride = 0;
+    std::vector<uint8_t> m_data;
+};
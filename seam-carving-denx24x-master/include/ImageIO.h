@@ -0,0 +1,20 @@
+#pragma once
+#include "Image.h"
+
+#include <optional>
+#include <string>
+
+/**
+ * Reads image from the file, the format is detected by its content:
+ * binary PPM (P6) and PAM (P7) with RGB pixels of 8 bits per channel are
+ * mapped to memory and copied to the image as is, anything else is read as
+ * CSV (width and height followed by red, green and blue of every pixel,
+ * column by column). Returns nothing if the file can't be read or is malformed
+ */
+std::optional<Image> ReadImage(const std::string & filename);
+
+/**
+ * Writes image to the file as binary PPM (.ppm), PAM (.pam) or CSV (any
+ * other extension). Returns false if the file can't be written
+ */
+bool WriteImage(const Image & image, const std::string & filename);
\ No newline at end of file
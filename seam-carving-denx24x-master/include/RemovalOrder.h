@@ -0,0 +1,53 @@
+#pragma once
+#include "Image.h"
+
+#include <iosfwd>
+
+/**
+ * Order, in which vertical seams remove pixels of the image: carving is run
+ * once until a single column is left, then the image is narrowed to any width
+ * by keeping the pixels removed last, without searching seams again
+ */
+class RemovalOrder
+{
+public:
+    /**
+     * Carves the image on threadsCount threads, 0 means a thread per core
+     */
+    RemovalOrder(const Image & image, size_t threadsCount = 0);
+
+    /**
+     * Reads removal indexes written by Write(), the order is empty and not
+     * valid if the input is truncated or a row isn't a permutation of [0:W-1]
+     */
+    RemovalOrder(std::istream & input);
+
+    bool IsValid() const;
+
+    size_t GetWidth() const;
+    size_t GetHeight() const;
+
+    /**
+     * Returns number of seams removed before the pixel
+     * (W - 1 for pixels of the last column left)
+     */
+    size_t GetRemovalIndex(size_t columnId, size_t rowId) const;
+
+    /**
+     * Returns the image of the same size as the order narrowed to the width
+     * in [0:W], same as after removing W - width vertical seams with SeamCarver
+     */
+    Image Retarget(const Image & image, size_t width) const;
+
+    /**
+     * Writes size and then removal indexes row by row
+     */
+    void Write(std::ostream & output) const;
+
+private:
+    size_t m_width = 0;
+    size_t m_height = 0;
+    bool m_valid = true;
+    // row-major like the image
+    std::vector<uint32_t> m_order;
+};
\ No newline at end of file
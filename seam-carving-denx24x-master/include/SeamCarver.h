@@ -1,9 +1,38 @@
 #pragma once
 #include "Image.h"
 
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+
+class WorkerPool;
+
+/**
+ * Const methods may be called from several threads at once, other ones
+ * need the carver for themselves
+ */
 class SeamCarver
 {
     using Seam = std::vector<size_t>;
+
+    /**
+     * Seam search buffers reused from seam to seam: costs of the last rows
+     * (a ring of band + 1 rows) and moves to the previous row (-1, 0 or 1)
+     * for every pixel. Searches take them in turn under m_mutex, a copy of
+     * the carver gets buffers of its own.
+     */
+    struct SeamSearch
+    {
+        SeamSearch() = default;
+        SeamSearch(const SeamSearch &);
+        SeamSearch & operator=(const SeamSearch &);
+
+        std::vector<double> m_costs;
+        std::vector<int8_t> m_moves;
+        std::mutex m_mutex;
+    };
+
     struct EnergyMap
     {
         EnergyMap(size_t w, size_t h);
@@ -11,15 +40,30 @@ class SeamCarver
         size_t GetWidth() const;
         size_t GetHeight() const;
         double Get(size_t x, size_t y) const;
+        void Set(size_t x, size_t y, double value);
+        double * GetRow(size_t y);
 
-        std::vector<std::vector<double>> m_data;
+        /**
+         * Keeps top left part of the size, like Image::Crop
+         */
+        void Crop(size_t w, size_t h);
+
+        size_t m_width;
+        size_t m_height;
+        // row-major like the image, rows stay m_stride apart when cropped
+        size_t m_stride;
+        std::vector<double> m_data;
     };
 
 public:
-    SeamCarver(Image image);
+    /**
+     * Energy and seams of large images are computed on threadsCount threads,
+     * 0 means a thread per core
+     */
+    SeamCarver(Image image, size_t threadsCount = 0);
 
     /**
-     * Returns current image
+     * Returns current image, it doesn't change until a seam is removed
      */
     const Image & GetImage() const;
 
@@ -52,6 +96,22 @@ public:
      */
     Seam FindVerticalSeam() const;
 
+    /**
+     * Returns up to count horizontal seams, that don't cross or touch each
+     * other, found with a single search (the first one is FindHorizontalSeam()).
+     * Further seams follow the cheapest paths to other cells of the last column
+     * and step aside where those run into seams already taken, so they may be
+     * worse than the ones found after removing the previous seam. Seams costing
+     * more than (1 + tolerance) times the first one aren't returned: larger
+     * tolerance trades quality for fewer searches.
+     */
+    std::vector<Seam> FindHorizontalSeams(size_t count, double tolerance = 0.1) const;
+
+    /**
+     * Same as FindHorizontalSeams() for vertical seams
+     */
+    std::vector<Seam> FindVerticalSeams(size_t count, double tolerance = 0.1) const;
+
     /**
      * Removes sequence of pixels from the image
      */
@@ -62,8 +122,154 @@ public:
      */
     void RemoveVerticalSeam(const Seam & seam);
 
+    /**
+     * Removes seams returned by FindHorizontalSeams() at once
+     */
+    void RemoveHorizontalSeams(const std::vector<Seam> & seams);
+
+    /**
+     * Removes seams returned by FindVerticalSeams() at once
+     */
+    void RemoveVerticalSeams(const std::vector<Seam> & seams);
+
 private:
-    Seam FindSeam(const EnergyMap & energy, bool transposed) const;
+    // smallest part of a row a thread gets, smaller images aren't split
+    static constexpr size_t MinBlockWidth = 32;
+    // images with less pixels are processed on a single thread
+    static constexpr size_t MinParallelSize = 1 << 16;
+
+    /**
+     * Calls task(id) for id in [0:count-1], concurrently if there are workers
+     */
+    void Run(size_t count, const std::function<void(size_t)> & task) const;
+
+    /**
+     * Calls computeRow(row, begin, end) to fill cells [begin, end) of every row
+     * in [1:rows-1], each cell depends on three adjacent cells of the previous row.
+     * Rows are split in blocks computed concurrently in bands of several rows:
+     * first every block computes the part, that doesn't depend on its neighbours
+     * (trapezoid narrowing by a cell on each side with every row), then gaps
+     * between blocks are filled, so there are two barriers per band.
+     */
+    void RunWavefront(size_t rows, size_t width, const std::function<void(size_t, size_t, size_t)> & computeRow) const;
+
+    /**
+     * Returns number of blocks rows of the width are split in by RunWavefront()
+     */
+    size_t GetWavefrontBlocksCount(size_t width) const;
+
+    /**
+     * Returns number of rows RunWavefront() computes in a band, while a band
+     * is computed only its rows and the one before it are accessed
+     */
+    size_t GetWavefrontBand(size_t width) const;
+
+    /**
+     * Finds seam across the rows of the image as it is laid out now
+     */
+    Seam FindSeam() const;
+    std::vector<Seam> FindSeams(size_t count, double tolerance) const;
+
+    /**
+     * Computes moves of the cheapest seams ending at every cell and returns
+     * their costs for the cells of the last row
+     */
+    const double * CalculateSeamCosts(SeamSearch & search) const;
+
+    /**
+     * Follows the moves from the cell of the last row back to the first one
+     */
+    Seam TraceSeam(const SeamSearch & search, size_t position) const;
     EnergyMap CalculateEnergyMap() const;
-    Image m_image;
+
+    /**
+     * Calls search() with the buffers laid out for seams of the direction,
+     * the layout is changed under the exclusive lock, if it doesn't match
+     */
+    template <class Search>
+    auto WithLayout(bool transposed, Search && search) const;
+
+    /**
+     * Copies the image out of the buffers without gaps and transposition
+     */
+    Image BuildImage() const;
+
+    /**
+     * Lays the image and the energy map out with rows along the logical
+     * columns (transposed) or along the logical rows, so seams of either
+     * direction cross the rows of the buffers and are scanned in memory order
+     */
+    void SetTransposed(bool transposed) const;
+
+    /**
+     * Energy of pixel (x, y) of the image as it is laid out now
+     */
+    double CalculateEnergy(size_t x, size_t y) const;
+
+    /**
+     * Position of pixel (x, y) of the row in the buffers, which is after the gap
+     */
+    size_t GetPhysicalColumn(size_t x, size_t y) const;
+    const uint8_t * GetPixelData(size_t x, size_t y) const;
+
+    /**
+     * Recomputes energy of the pixel from its current neighbours
+     */
+    void UpdateEnergy(size_t x, size_t y);
+
+    /**
+     * Removes seam crossing the rows of the image as it is laid out now
+     */
+    void RemoveSeam(const Seam & seam);
+    void RemoveSeams(const std::vector<Seam> & seams);
+
+    /**
+     * Recomputes energy of pixels, whose neighbours changed with the seam removal
+     */
+    void UpdateEnergyAfterSeam(const Seam & seam);
+
+    /**
+     * Moves gap of the row to the pixel at position, so the pixel is in the
+     * gap, pixels in between are moved to the other side of the gap
+     */
+    void MoveGap(size_t row, size_t position);
+
+    /**
+     * Moves pixels left in the buffers after gaps to close them
+     */
+    void Compact() const;
+
+    /**
+     * Mutex, that a copy of the carver doesn't share
+     */
+    struct Mutex
+    {
+        Mutex() = default;
+        Mutex(const Mutex &);
+        Mutex & operator=(const Mutex &);
+
+        std::shared_mutex m_mutex;
+    };
+
+    // Removed pixels aren't moved out of the buffers at once: every row has
+    // a gap of m_gapSize removed pixels, that starts at m_gaps[row] and moves
+    // to the next removed pixel, so a removal costs O(H) plus the distance
+    // between consecutive seams. While horizontal seams are searched for and
+    // removed the image and the energy map are stored transposed. The buffers
+    // are compacted, when seams of the other direction are needed. Const
+    // methods read the buffers under a shared lock of m_mutex and lay them
+    // out again under the exclusive one.
+    mutable Image m_image;
+    std::shared_ptr<WorkerPool> m_workers;
+    mutable std::vector<size_t> m_gaps;
+    mutable size_t m_gapSize = 0;
+    mutable bool m_transposed = false;
+    // energy of every pixel, kept up to date on seam removals
+    mutable EnergyMap m_energy;
+    // image returned by GetImage(), built again after seam removals
+    mutable Image m_output;
+    mutable bool m_outputValid = false;
+    mutable Mutex m_mutex;
+    // seam searches lock it after m_mutex
+    mutable SeamSearch m_search;
 };
\ No newline at end of file
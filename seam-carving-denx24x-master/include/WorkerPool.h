@@ -0,0 +1,50 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Fixed set of threads running batches of tasks
+ */
+class WorkerPool
+{
+public:
+    /**
+     * Starts threadsCount - 1 threads, the thread calling Run() is the last one
+     */
+    WorkerPool(size_t threadsCount);
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool & operator=(const WorkerPool &) = delete;
+    ~WorkerPool();
+
+    size_t GetThreadsCount() const;
+
+    /**
+     * Calls task(id) for every id in [0:count-1] concurrently and returns once
+     * all of them are done, so consecutive calls are separated by a barrier.
+     * Calls from different threads are run one after another.
+     */
+    void Run(size_t count, const std::function<void(size_t)> & task);
+
+private:
+    void Work();
+    void RunTasks();
+
+    std::vector<std::thread> m_threads;
+    std::mutex m_runMutex;
+    std::mutex m_mutex;
+    std::condition_variable m_started;
+    std::condition_variable m_finished;
+    // the batch being run, changed only when no worker is in it
+    const std::function<void(size_t)> * m_task = nullptr;
+    size_t m_count = 0;
+    size_t m_generation = 0;
+    size_t m_active = 0;
+    bool m_stop = false;
+    std::atomic<size_t> m_next = 0;
+    std::atomic<size_t> m_unfinished = 0;
+};
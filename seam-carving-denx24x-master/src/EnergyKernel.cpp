@@ -0,0 +1,155 @@
+#include "EnergyKernel.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define SEAM_CARVING_X86
+#endif
+
+namespace {
+// pixels of a row, whose gradients are computed at once
+constexpr size_t GradientsChunkSize = 256;
+
+int GetSquaredDifference(const uint8_t * left, const uint8_t * right)
+{
+    int result = 0;
+    for (size_t channel = 0; channel < Image::PixelSize; channel++) {
+        const int difference = left[channel] - right[channel];
+        result += difference * difference;
+    }
+    return result;
+}
+
+double GetEnergy(int squaredGradient, bool squared)
+{
+    return squared ? squaredGradient : sqrt(squaredGradient);
+}
+
+// For bytes [begin, end) of the row: squared difference of the same channel
+// of the pixels on the left and on the right plus the one of the pixels
+// above and below. Requires begin >= PixelSize and end + PixelSize <= row size.
+using SquaredGradients = void (*)(const uint8_t * row, const uint8_t * up, const uint8_t * down, size_t begin, size_t end, int32_t * result);
+
+void GetSquaredGradientsScalar(const uint8_t * row, const uint8_t * up, const uint8_t * down, size_t begin, size_t end, int32_t * result)
+{
+    for (size_t i = begin; i < end; i++) {
+        const int32_t dx = row[i + Image::PixelSize] - row[i - Image::PixelSize];
+        const int32_t dy = down[i] - up[i];
+        result[i] = dx * dx + dy * dy;
+    }
+}
+
+#ifdef SEAM_CARVING_X86
+
+void GetSquaredGradientsSse2(const uint8_t * row, const uint8_t * up, const uint8_t * down, size_t begin, size_t end, int32_t * result)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const auto load = [&zero](const uint8_t * data) {
+        return _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(data)), zero);
+    };
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        const __m128i dx = _mm_sub_epi16(load(row + i + Image::PixelSize), load(row + i - Image::PixelSize));
+        const __m128i dy = _mm_sub_epi16(load(down + i), load(up + i));
+        // pairs (dx, dy) multiplied by themselves and summed give 32 bit results
+        const __m128i low = _mm_unpacklo_epi16(dx, dy);
+        const __m128i high = _mm_unpackhi_epi16(dx, dy);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(result + i), _mm_madd_epi16(low, low));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(result + i + 4), _mm_madd_epi16(high, high));
+    }
+    GetSquaredGradientsScalar(row, up, down, i, end, result);
+}
+
+__attribute__((target("avx2"))) __m256i LoadWidened(const uint8_t * data)
+{
+    return _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data)));
+}
+
+__attribute__((target("avx2"))) void GetSquaredGradientsAvx2(const uint8_t * row, const uint8_t * up, const uint8_t * down, size_t begin, size_t end, int32_t * result)
+{
+    size_t i = begin;
+    for (; i + 16 <= end; i += 16) {
+        const __m256i dx = _mm256_sub_epi16(LoadWidened(row + i + Image::PixelSize), LoadWidened(row + i - Image::PixelSize));
+        const __m256i dy = _mm256_sub_epi16(LoadWidened(down + i), LoadWidened(up + i));
+        // unpacking works within 128 bit lanes: low has bytes 0-3 and 8-11, high has 4-7 and 12-15
+        const __m256i low = _mm256_unpacklo_epi16(dx, dy);
+        const __m256i high = _mm256_unpackhi_epi16(dx, dy);
+        const __m256i lowSums = _mm256_madd_epi16(low, low);
+        const __m256i highSums = _mm256_madd_epi16(high, high);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(result + i), _mm256_permute2x128_si256(lowSums, highSums, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(result + i + 8), _mm256_permute2x128_si256(lowSums, highSums, 0x31));
+    }
+    GetSquaredGradientsScalar(row, up, down, i, end, result);
+}
+
+SquaredGradients ChooseSquaredGradients()
+{
+    if (__builtin_cpu_supports("avx2")) {
+        return GetSquaredGradientsAvx2;
+    }
+    return GetSquaredGradientsSse2;
+}
+
+#else
+
+SquaredGradients ChooseSquaredGradients()
+{
+    return GetSquaredGradientsScalar;
+}
+
+#endif
+} // namespace
+
+double CalculatePixelEnergy(const Image & image, size_t x, size_t y, bool squared)
+{
+    const size_t width = image.GetWidth();
+    const size_t height = image.GetHeight();
+    const uint8_t * row = image.GetRowData(y);
+    const size_t left = (x == 0 ? width : x) - 1;
+    const size_t right = x + 1 == width ? 0 : x + 1;
+    const size_t up = (y == 0 ? height : y) - 1;
+    const size_t down = y + 1 == height ? 0 : y + 1;
+    const size_t column = x * Image::PixelSize;
+    return CalculatePixelEnergy(row + left * Image::PixelSize, row + right * Image::PixelSize, image.GetRowData(up) + column, image.GetRowData(down) + column, squared);
+}
+
+double CalculatePixelEnergy(const uint8_t * left, const uint8_t * right, const uint8_t * up, const uint8_t * down, bool squared)
+{
+    return GetEnergy(GetSquaredDifference(right, left) + GetSquaredDifference(down, up), squared);
+}
+
+void CalculateRowEnergy(const Image & image, size_t y, double * energy, bool squared)
+{
+    static const SquaredGradients getSquaredGradients = ChooseSquaredGradients();
+
+    const size_t width = image.GetWidth();
+    const size_t height = image.GetHeight();
+    if (width == 0) {
+        return;
+    }
+    // border pixels have neighbours on the other side
+    energy[0] = CalculatePixelEnergy(image, 0, y, squared);
+    if (width > 1) {
+        energy[width - 1] = CalculatePixelEnergy(image, width - 1, y, squared);
+    }
+    if (width <= 2) {
+        return;
+    }
+    const uint8_t * row = image.GetRowData(y);
+    const uint8_t * up = image.GetRowData((y == 0 ? height : y) - 1);
+    const uint8_t * down = image.GetRowData(y + 1 == height ? 0 : y + 1);
+    // row is processed in chunks of pixels [begin, begin + count) on the stack,
+    // gradients of a chunk start with the pixel before it
+    int32_t gradients[(GradientsChunkSize + 1) * Image::PixelSize];
+    for (size_t begin = 1; begin + 1 < width; begin += GradientsChunkSize) {
+        const size_t count = std::min(GradientsChunkSize, width - 1 - begin);
+        const size_t offset = (begin - 1) * Image::PixelSize;
+        getSquaredGradients(row + offset, up + offset, down + offset, Image::PixelSize, (count + 1) * Image::PixelSize, gradients);
+        for (size_t x = 0; x < count; x++) {
+            const int32_t * channels = gradients + (x + 1) * Image::PixelSize;
+            energy[begin + x] = GetEnergy(channels[0] + channels[1] + channels[2], squared);
+        }
+    }
+}
@@ -3,7 +3,20 @@
 #include <cmath>
 
 Image::Image(std::vector<std::vector<Image::Pixel>> table)
-    : m_table(std::move(table))
+    : Image(table.size(), table.empty() ? 0 : table[0].size())
+{
+    for (size_t columnId = 0; columnId < m_width; columnId++) {
+        for (size_t rowId = 0; rowId < m_height; rowId++) {
+            SetPixel(columnId, rowId, table[columnId][rowId]);
+        }
+    }
+}
+
+Image::Image(size_t width, size_t height)
+    : m_width(height == 0 ? 0 : width)
+    , m_height(width == 0 ? 0 : height)
+    , m_stride(m_width * PixelSize)
+    , m_data(m_stride * m_height)
 {
 }
 
@@ -24,6 +37,24 @@ int Image::Pixel::GetSumOfSquaresOfComponents() const
     return pow(m_red, 2) + pow(m_green, 2) + pow(m_blue, 2);
 }
 
+Image::View::View(const uint8_t * data, size_t size, size_t step)
+    : m_data(data)
+    , m_size(size)
+    , m_step(step)
+{
+}
+
+size_t Image::View::size() const
+{
+    return m_size;
+}
+
+Image::Pixel Image::View::operator[](size_t id) const
+{
+    const uint8_t * pixel = m_data + id * m_step;
+    return Pixel(pixel[0], pixel[1], pixel[2]);
+}
+
 size_t Image::GetColumnIdNormalized(size_t columnId) const
 {
     return (GetWidth() + columnId) % GetWidth();
@@ -36,15 +67,59 @@ size_t Image::GetRowIdNormalized(size_t rowId) const
 
 Image::Pixel Image::GetPixel(size_t columnId, size_t rowId) const
 {
-    return m_table[columnId][rowId];
+    const uint8_t * pixel = GetRowData(rowId) + columnId * PixelSize;
+    return Pixel(pixel[0], pixel[1], pixel[2]);
+}
+
+void Image::SetPixel(size_t columnId, size_t rowId, const Pixel & pixel)
+{
+    uint8_t * data = GetRowData(rowId) + columnId * PixelSize;
+    data[0] = static_cast<uint8_t>(pixel.m_red);
+    data[1] = static_cast<uint8_t>(pixel.m_green);
+    data[2] = static_cast<uint8_t>(pixel.m_blue);
 }
 
 size_t Image::GetWidth() const
 {
-    return m_table.size();
+    return m_width;
 }
 
 size_t Image::GetHeight() const
 {
-    return m_table.empty() ? 0 : m_table[0].size();
+    return m_height;
+}
+
+size_t Image::GetStride() const
+{
+    return m_stride;
+}
+
+Image::View Image::GetRow(size_t rowId) const
+{
+    return View(GetRowData(rowId), m_width, PixelSize);
+}
+
+Image::View Image::GetColumn(size_t columnId) const
+{
+    return View(m_data.data() + columnId * PixelSize, m_height, m_stride);
+}
+
+const uint8_t * Image::GetRowData(size_t rowId) const
+{
+    return m_data.data() + rowId * m_stride;
+}
+
+uint8_t * Image::GetRowData(size_t rowId)
+{
+    return m_data.data() + rowId * m_stride;
+}
+
+void Image::Crop(size_t width, size_t height)
+{
+    if (width == 0 || height == 0) {
+        width = 0;
+        height = 0;
+    }
+    m_width = width;
+    m_height = height;
 }
@@ -0,0 +1,355 @@
+#include "ImageIO.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SEAM_CARVING_MMAP
+#endif
+
+namespace {
+constexpr size_t MaxChannelValue = 255;
+// shortest pixel line of CSV is "0 0 0\n"
+constexpr size_t MinCSVPixelSize = 6;
+// CSV is written in chunks of about this size
+constexpr size_t WriteBufferSize = 1 << 20;
+
+/**
+ * Contents of a file: mapped to memory where it's possible, read otherwise
+ */
+class MappedFile
+{
+public:
+    MappedFile(const std::string & filename);
+    MappedFile(const MappedFile &) = delete;
+    MappedFile & operator=(const MappedFile &) = delete;
+    ~MappedFile();
+
+    bool IsOpen() const;
+    const char * GetData() const;
+    size_t GetSize() const;
+
+private:
+    bool m_open = false;
+    const char * m_data = nullptr;
+    size_t m_size = 0;
+    void * m_mapping = nullptr;
+    std::vector<char> m_buffer;
+};
+
+MappedFile::MappedFile(const std::string & filename)
+{
+#ifdef SEAM_CARVING_MMAP
+    const int descriptor = open(filename.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        return;
+    }
+    struct stat status;
+    if (fstat(descriptor, &status) == 0 && S_ISREG(status.st_mode)) {
+        m_open = true;
+        m_size = static_cast<size_t>(status.st_size);
+        if (m_size != 0) {
+            void * mapping = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+            if (mapping != MAP_FAILED) {
+                madvise(mapping, m_size, MADV_SEQUENTIAL);
+                m_mapping = mapping;
+                m_data = static_cast<const char *>(mapping);
+            }
+        }
+    }
+    close(descriptor);
+    if (m_data != nullptr || (m_open && m_size == 0)) {
+        return;
+    }
+    m_open = false;
+    m_size = 0;
+#endif
+    // files, that can't be mapped, are read to the buffer
+    std::ifstream input(filename, std::ios::binary);
+    if (!input.good()) {
+        return;
+    }
+    m_buffer.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    m_open = true;
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+}
+
+MappedFile::~MappedFile()
+{
+#ifdef SEAM_CARVING_MMAP
+    if (m_mapping != nullptr) {
+        munmap(m_mapping, m_size);
+    }
+#endif
+}
+
+bool MappedFile::IsOpen() const
+{
+    return m_open;
+}
+
+const char * MappedFile::GetData() const
+{
+    return m_data;
+}
+
+size_t MappedFile::GetSize() const
+{
+    return m_size;
+}
+
+/**
+ * Reads whitespace separated tokens and numbers from the text
+ */
+class TextReader
+{
+public:
+    TextReader(const char * begin, const char * end);
+
+    /**
+     * Skips whitespace and comments from # to the end of line
+     */
+    void SkipWhitespace();
+
+    bool ReadNumber(size_t & value);
+    bool ReadToken(std::string & token);
+    const char * GetPosition() const;
+
+private:
+    const char * m_position;
+    const char * m_end;
+};
+
+TextReader::TextReader(const char * begin, const char * end)
+    : m_position(begin)
+    , m_end(end)
+{
+}
+
+void TextReader::SkipWhitespace()
+{
+    while (m_position != m_end) {
+        if (*m_position == '#') {
+            m_position = std::find(m_position, m_end, '\n');
+        }
+        else if (*m_position == ' ' || *m_position == '\n' || *m_position == '\r' || *m_position == '\t') {
+            m_position++;
+        }
+        else {
+            return;
+        }
+    }
+}
+
+bool TextReader::ReadNumber(size_t & value)
+{
+    SkipWhitespace();
+    const auto [end, error] = std::from_chars(m_position, m_end, value);
+    m_position = end;
+    return error == std::errc();
+}
+
+bool TextReader::ReadToken(std::string & token)
+{
+    SkipWhitespace();
+    const char * begin = m_position;
+    while (m_position != m_end && !std::isspace(static_cast<unsigned char>(*m_position))) {
+        m_position++;
+    }
+    token.assign(begin, m_position);
+    return !token.empty();
+}
+
+const char * TextReader::GetPosition() const
+{
+    return m_position;
+}
+
+std::optional<Image> ReadImageFromCSV(const char * data, size_t size)
+{
+    TextReader reader(data, data + size);
+    size_t width, height;
+    if (!reader.ReadNumber(width) || !reader.ReadNumber(height)) {
+        return std::nullopt;
+    }
+    // sizes of a truncated file aren't allocated
+    if (width != 0 && size / MinCSVPixelSize / width < height) {
+        return std::nullopt;
+    }
+    Image image(width, height);
+    for (size_t columnId = 0; columnId < width; ++columnId) {
+        for (size_t rowId = 0; rowId < height; ++rowId) {
+            uint8_t * pixel = image.GetRowData(rowId) + columnId * Image::PixelSize;
+            for (size_t channel = 0; channel < Image::PixelSize; channel++) {
+                size_t value;
+                if (!reader.ReadNumber(value)) {
+                    return std::nullopt;
+                }
+                pixel[channel] = static_cast<uint8_t>(value);
+            }
+        }
+    }
+    return image;
+}
+
+/**
+ * Copies packed RGB rows following the header to the image
+ */
+std::optional<Image> ReadPixels(const char * pixels, const char * end, size_t width, size_t height)
+{
+    if (width != 0 && static_cast<size_t>(end - pixels) / Image::PixelSize / width < height) {
+        return std::nullopt;
+    }
+    Image image(width, height);
+    const size_t rowSize = width * Image::PixelSize;
+    for (size_t rowId = 0; rowId < height; rowId++) {
+        std::memcpy(image.GetRowData(rowId), pixels + rowId * rowSize, rowSize);
+    }
+    return image;
+}
+
+std::optional<Image> ReadImageFromPPM(const char * data, size_t size)
+{
+    TextReader reader(data + 2, data + size);
+    size_t width, height, maxValue;
+    if (!reader.ReadNumber(width) || !reader.ReadNumber(height) || !reader.ReadNumber(maxValue) || maxValue != MaxChannelValue) {
+        return std::nullopt;
+    }
+    // single whitespace character separates the header from pixels
+    const char * pixels = reader.GetPosition();
+    if (pixels == data + size) {
+        return std::nullopt;
+    }
+    return ReadPixels(pixels + 1, data + size, width, height);
+}
+
+std::optional<Image> ReadImageFromPAM(const char * data, size_t size)
+{
+    TextReader reader(data + 2, data + size);
+    size_t width = 0, height = 0, depth = 0, maxValue = 0;
+    std::string token;
+    while (reader.ReadToken(token) && token != "ENDHDR") {
+        bool valid = true;
+        if (token == "WIDTH") {
+            valid = reader.ReadNumber(width);
+        }
+        else if (token == "HEIGHT") {
+            valid = reader.ReadNumber(height);
+        }
+        else if (token == "DEPTH") {
+            valid = reader.ReadNumber(depth);
+        }
+        else if (token == "MAXVAL") {
+            valid = reader.ReadNumber(maxValue);
+        }
+        else if (token == "TUPLTYPE") {
+            valid = reader.ReadToken(token) && token == "RGB";
+        }
+        if (!valid) {
+            return std::nullopt;
+        }
+    }
+    // header ends with a newline after ENDHDR
+    const char * pixels = reader.GetPosition();
+    if (token != "ENDHDR" || pixels == data + size || depth != Image::PixelSize || maxValue != MaxChannelValue) {
+        return std::nullopt;
+    }
+    return ReadPixels(pixels + 1, data + size, width, height);
+}
+
+bool HasExtension(const std::string & filename, const char * extension)
+{
+    const size_t length = std::strlen(extension);
+    if (filename.size() < length) {
+        return false;
+    }
+    return std::equal(extension, extension + length, filename.end() - length, [](char left, char right) {
+        return left == std::tolower(static_cast<unsigned char>(right));
+    });
+}
+
+/**
+ * Writes header and then packed RGB rows
+ */
+bool WritePixels(const Image & image, const std::string & header, const std::string & filename)
+{
+    std::ofstream output(filename, std::ios::binary);
+    output.write(header.data(), header.size());
+    const size_t rowSize = image.GetWidth() * Image::PixelSize;
+    for (size_t rowId = 0; rowId < image.GetHeight(); rowId++) {
+        output.write(reinterpret_cast<const char *>(image.GetRowData(rowId)), rowSize);
+    }
+    return output.good();
+}
+
+bool WriteImageToCSV(const Image & image, const std::string & filename)
+{
+    std::ofstream output(filename, std::ios::binary);
+    std::vector<char> buffer(WriteBufferSize);
+    char * position = buffer.data();
+    // longest line is the header of two numbers of size_t
+    constexpr size_t MaxLineSize = 64;
+    const auto write = [&](size_t value, char separator) {
+        position = std::to_chars(position, buffer.data() + buffer.size(), value).ptr;
+        *position++ = separator;
+    };
+    const auto flush = [&] {
+        output.write(buffer.data(), position - buffer.data());
+        position = buffer.data();
+    };
+    write(image.GetWidth(), ' ');
+    write(image.GetHeight(), '\n');
+    for (size_t columnId = 0; columnId < image.GetWidth(); ++columnId) {
+        for (size_t rowId = 0; rowId < image.GetHeight(); ++rowId) {
+            if (position + MaxLineSize > buffer.data() + buffer.size()) {
+                flush();
+            }
+            const uint8_t * pixel = image.GetRowData(rowId) + columnId * Image::PixelSize;
+            write(pixel[0], ' ');
+            write(pixel[1], ' ');
+            write(pixel[2], '\n');
+        }
+    }
+    flush();
+    return output.good();
+}
+} // namespace
+
+std::optional<Image> ReadImage(const std::string & filename)
+{
+    const MappedFile file(filename);
+    if (!file.IsOpen()) {
+        return std::nullopt;
+    }
+    const char * data = file.GetData();
+    const size_t size = file.GetSize();
+    if (size >= 2 && data[0] == 'P' && data[1] == '6') {
+        return ReadImageFromPPM(data, size);
+    }
+    if (size >= 2 && data[0] == 'P' && data[1] == '7') {
+        return ReadImageFromPAM(data, size);
+    }
+    return ReadImageFromCSV(data, size);
+}
+
+bool WriteImage(const Image & image, const std::string & filename)
+{
+    const std::string width = std::to_string(image.GetWidth());
+    const std::string height = std::to_string(image.GetHeight());
+    if (HasExtension(filename, ".ppm")) {
+        return WritePixels(image, "P6\n" + width + " " + height + "\n255\n", filename);
+    }
+    if (HasExtension(filename, ".pam")) {
+        return WritePixels(image, "P7\nWIDTH " + width + "\nHEIGHT " + height + "\nDEPTH 3\nMAXVAL 255\nTUPLTYPE RGB\nENDHDR\n", filename);
+    }
+    return WriteImageToCSV(image, filename);
+}
@@ -0,0 +1,122 @@
+#include "RemovalOrder.h"
+
+#include "SeamCarver.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+
+RemovalOrder::RemovalOrder(const Image & image, size_t threadsCount)
+{
+    if (image.GetWidth() == 0 || image.GetHeight() == 0) {
+        return;
+    }
+    m_width = image.GetWidth();
+    m_height = image.GetHeight();
+    m_order.assign(m_width * m_height, static_cast<uint32_t>(m_width - 1));
+    // original columns of the pixels left in every row
+    std::vector<std::vector<uint32_t>> columns(m_height, std::vector<uint32_t>(m_width));
+    for (auto & row : columns) {
+        for (size_t columnId = 0; columnId < m_width; columnId++) {
+            row[columnId] = static_cast<uint32_t>(columnId);
+        }
+    }
+    SeamCarver carver(image, threadsCount);
+    for (size_t step = 0; step + 1 < m_width; step++) {
+        const auto seam = carver.FindVerticalSeam();
+        for (size_t rowId = 0; rowId < m_height; rowId++) {
+            auto & row = columns[rowId];
+            m_order[rowId * m_width + row[seam[rowId]]] = static_cast<uint32_t>(step);
+            row.erase(row.begin() + seam[rowId]);
+        }
+        carver.RemoveVerticalSeam(seam);
+    }
+}
+
+RemovalOrder::RemovalOrder(std::istream & input)
+{
+    size_t width = 0, height = 0;
+    input >> width >> height;
+    m_valid = !input.fail() && width <= UINT32_MAX && (width == 0 || height <= SIZE_MAX / width);
+    // indexes are appended as they are read, so the header can't make
+    // the order take more memory than the input holds
+    for (size_t pixelId = 0; m_valid && pixelId < width * height; pixelId++) {
+        uint32_t index = 0;
+        m_valid = static_cast<bool>(input >> index);
+        if (m_valid) {
+            m_order.push_back(index);
+        }
+    }
+    // every row is removed one pixel at a time
+    std::vector<bool> seen(m_valid ? width : 0);
+    for (size_t rowId = 0; rowId < height && m_valid; rowId++) {
+        std::fill(seen.begin(), seen.end(), false);
+        for (size_t columnId = 0; columnId < width && m_valid; columnId++) {
+            const uint32_t index = m_order[rowId * width + columnId];
+            m_valid = index < width && !seen[index];
+            if (m_valid) {
+                seen[index] = true;
+            }
+        }
+    }
+    if (!m_valid) {
+        m_order.clear();
+        return;
+    }
+    m_width = width;
+    m_height = height;
+}
+
+bool RemovalOrder::IsValid() const
+{
+    return m_valid;
+}
+
+size_t RemovalOrder::GetWidth() const
+{
+    return m_width;
+}
+
+size_t RemovalOrder::GetHeight() const
+{
+    return m_height;
+}
+
+size_t RemovalOrder::GetRemovalIndex(size_t columnId, size_t rowId) const
+{
+    return m_order[rowId * m_width + columnId];
+}
+
+Image RemovalOrder::Retarget(const Image & image, size_t width) const
+{
+    width = std::min(width, m_width);
+    Image result(width, width == 0 ? 0 : m_height);
+    // pixels removed by the first W - width seams are skipped, the rest keep their order
+    const size_t removed = m_width - width;
+    for (size_t rowId = 0; rowId < result.GetHeight(); rowId++) {
+        const uint32_t * order = m_order.data() + rowId * m_width;
+        const uint8_t * source = image.GetRowData(rowId);
+        uint8_t * destination = result.GetRowData(rowId);
+        const uint8_t * end = destination + width * Image::PixelSize;
+        for (size_t columnId = 0; columnId < m_width && destination != end; columnId++) {
+            if (order[columnId] >= removed) {
+                std::memcpy(destination, source + columnId * Image::PixelSize, Image::PixelSize);
+                destination += Image::PixelSize;
+            }
+        }
+    }
+    return result;
+}
+
+void RemovalOrder::Write(std::ostream & output) const
+{
+    output << m_width << " " << m_height << "\n";
+    for (size_t rowId = 0; rowId < m_height; rowId++) {
+        for (size_t columnId = 0; columnId < m_width; columnId++) {
+            output << (columnId == 0 ? "" : " ") << GetRemovalIndex(columnId, rowId);
+        }
+        output << "\n";
+    }
+}
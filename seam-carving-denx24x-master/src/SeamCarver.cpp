@@ -1,124 +1,556 @@
 #include "SeamCarver.h"
 
+#include "EnergyKernel.h"
+#include "WorkerPool.h"
+
 #include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <thread>
+
+namespace {
+// side of square blocks transposed at once, so that both source and
+// destination lines of a block stay in cache
+constexpr size_t TransposeBlockSize = 32;
+
+/**
+ * Writes elements of size Size of the source rows [begin, end) to the
+ * destination columns, (x, y) goes to (y, x)
+ */
+template <size_t Size>
+void TransposeRows(const uint8_t * source, size_t sourceStride, uint8_t * destination, size_t destinationStride, size_t width, size_t begin, size_t end)
+{
+    for (size_t blockRow = begin; blockRow < end; blockRow += TransposeBlockSize) {
+        const size_t rowsEnd = std::min(end, blockRow + TransposeBlockSize);
+        for (size_t blockColumn = 0; blockColumn < width; blockColumn += TransposeBlockSize) {
+            const size_t columnsEnd = std::min(width, blockColumn + TransposeBlockSize);
+            for (size_t x = blockColumn; x < columnsEnd; x++) {
+                uint8_t * line = destination + x * destinationStride;
+                for (size_t y = blockRow; y < rowsEnd; y++) {
+                    std::memcpy(line + y * Size, source + y * sourceStride + x * Size, Size);
+                }
+            }
+        }
+    }
+}
+} // namespace
 
 SeamCarver::EnergyMap::EnergyMap(size_t w, size_t h)
-    : m_data(w, std::vector<double>(h))
+    : m_width(w)
+    , m_height(h)
+    , m_stride(w)
+    , m_data(w * h)
 {
 }
 
 size_t SeamCarver::EnergyMap::GetWidth() const
 {
-    return m_data.size();
+    return m_width;
 }
 
 size_t SeamCarver::EnergyMap::GetHeight() const
 {
-    return m_data.empty() ? 0 : m_data[0].size();
+    return m_height;
 }
 
 double SeamCarver::EnergyMap::Get(size_t columnId, size_t rowId) const
 {
-    return m_data[columnId][rowId];
+    return m_data[rowId * m_stride + columnId];
+}
+
+void SeamCarver::EnergyMap::Set(size_t columnId, size_t rowId, double value)
+{
+    m_data[rowId * m_stride + columnId] = value;
+}
+
+double * SeamCarver::EnergyMap::GetRow(size_t rowId)
+{
+    return m_data.data() + rowId * m_stride;
+}
+
+void SeamCarver::EnergyMap::Crop(size_t w, size_t h)
+{
+    if (w == 0 || h == 0) {
+        w = 0;
+        h = 0;
+    }
+    m_width = w;
+    m_height = h;
 }
 
-SeamCarver::SeamCarver(Image image)
+SeamCarver::SeamCarver(Image image, size_t threadsCount)
     : m_image(std::move(image))
+    , m_workers(threadsCount != 1 && m_image.GetWidth() * m_image.GetHeight() >= MinParallelSize
+                        ? std::make_shared<WorkerPool>(threadsCount == 0 ? std::thread::hardware_concurrency() : threadsCount)
+                        : nullptr)
+    , m_energy(CalculateEnergyMap())
+    , m_output(0, 0)
+{
+}
+
+SeamCarver::Mutex::Mutex(const Mutex &)
+{
+}
+
+SeamCarver::Mutex & SeamCarver::Mutex::operator=(const Mutex &)
+{
+    return *this;
+}
+
+SeamCarver::SeamSearch::SeamSearch(const SeamSearch &)
+{
+}
+
+SeamCarver::SeamSearch & SeamCarver::SeamSearch::operator=(const SeamSearch &)
 {
+    return *this;
 }
 
 const Image & SeamCarver::GetImage() const
 {
-    return m_image;
+    std::unique_lock lock(m_mutex.m_mutex);
+    if (!m_outputValid) {
+        m_output = BuildImage();
+        m_outputValid = true;
+    }
+    return m_output;
 }
 
 size_t SeamCarver::GetImageWidth() const
 {
-    return m_image.GetWidth();
+    std::shared_lock lock(m_mutex.m_mutex);
+    return m_transposed ? m_image.GetHeight() : m_image.GetWidth() - m_gapSize;
 }
 
 size_t SeamCarver::GetImageHeight() const
 {
-    return m_image.GetHeight();
+    std::shared_lock lock(m_mutex.m_mutex);
+    return m_transposed ? m_image.GetWidth() - m_gapSize : m_image.GetHeight();
 }
 
 double SeamCarver::GetPixelEnergy(size_t x, size_t y) const
 {
-    double x_component = m_image.GetPixel(m_image.GetColumnIdNormalized(x + 1), y).GetDifference(m_image.GetPixel(m_image.GetColumnIdNormalized(x - 1), y)).GetSumOfSquaresOfComponents();
-    double y_component = m_image.GetPixel(x, m_image.GetRowIdNormalized(y + 1)).GetDifference(m_image.GetPixel(x, m_image.GetRowIdNormalized(y - 1))).GetSumOfSquaresOfComponents();
-    return sqrt(x_component + y_component);
+    std::shared_lock lock(m_mutex.m_mutex);
+    // energy doesn't change with transposition, neighbours just swap
+    return m_transposed ? CalculateEnergy(y, x) : CalculateEnergy(x, y);
+}
+
+template <class Search>
+auto SeamCarver::WithLayout(bool transposed, Search && search) const
+{
+    {
+        std::shared_lock lock(m_mutex.m_mutex);
+        if (m_transposed == transposed) {
+            return search();
+        }
+    }
+    std::unique_lock lock(m_mutex.m_mutex);
+    SetTransposed(transposed);
+    return search();
 }
 
 SeamCarver::Seam SeamCarver::FindHorizontalSeam() const
 {
-    return FindSeam(CalculateEnergyMap(), false);
+    return WithLayout(true, [this] {
+        return FindSeam();
+    });
 }
 
 SeamCarver::Seam SeamCarver::FindVerticalSeam() const
 {
-    return FindSeam(CalculateEnergyMap(), true);
+    return WithLayout(false, [this] {
+        return FindSeam();
+    });
+}
+
+std::vector<SeamCarver::Seam> SeamCarver::FindHorizontalSeams(size_t count, double tolerance) const
+{
+    return WithLayout(true, [this, count, tolerance] {
+        return FindSeams(count, tolerance);
+    });
+}
+
+std::vector<SeamCarver::Seam> SeamCarver::FindVerticalSeams(size_t count, double tolerance) const
+{
+    return WithLayout(false, [this, count, tolerance] {
+        return FindSeams(count, tolerance);
+    });
 }
 
 SeamCarver::EnergyMap SeamCarver::CalculateEnergyMap() const
 {
-    EnergyMap result(GetImageWidth(), GetImageHeight());
-    for (size_t i = 0; i < GetImageWidth(); i++) {
-        for (size_t g = 0; g < GetImageHeight(); g++) {
-            result.m_data[i][g] = GetPixelEnergy(i, g);
+    const size_t height = m_image.GetHeight();
+    EnergyMap result(m_image.GetWidth(), height);
+    const size_t blocksCount = m_workers ? m_workers->GetThreadsCount() : 1;
+    Run(blocksCount, [this, &result, blocksCount, height](size_t block) {
+        for (size_t g = height * block / blocksCount; g < height * (block + 1) / blocksCount; g++) {
+            CalculateRowEnergy(m_image, g, result.GetRow(g));
         }
+    });
+    return result;
+}
+
+Image SeamCarver::BuildImage() const
+{
+    const size_t width = m_image.GetWidth() - m_gapSize;
+    const size_t height = m_image.GetHeight();
+    Image packed(width, height);
+    for (size_t i = 0; i < height; i++) {
+        const size_t gap = m_gapSize == 0 ? width : m_gaps[i];
+        const uint8_t * source = m_image.GetRowData(i);
+        uint8_t * destination = packed.GetRowData(i);
+        std::memcpy(destination, source, gap * Image::PixelSize);
+        std::memcpy(destination + gap * Image::PixelSize, source + (gap + m_gapSize) * Image::PixelSize, (width - gap) * Image::PixelSize);
+    }
+    if (!m_transposed) {
+        return packed;
     }
+    Image result(height, width);
+    TransposeRows<Image::PixelSize>(packed.GetRowData(0), packed.GetStride(), result.GetRowData(0), result.GetStride(), width, 0, height);
     return result;
 }
 
-SeamCarver::Seam SeamCarver::FindSeam(const SeamCarver::EnergyMap & energy, bool transposed) const
+void SeamCarver::SetTransposed(bool transposed) const
+{
+    if (m_transposed == transposed) {
+        return;
+    }
+    Compact();
+    const size_t width = m_image.GetWidth();
+    const size_t height = m_image.GetHeight();
+    Image image(height, width);
+    EnergyMap energy(height, width);
+    const size_t blocksCount = m_workers ? m_workers->GetThreadsCount() : 1;
+    Run(blocksCount, [&](size_t block) {
+        // bands of whole blocks, so that threads write different cache lines
+        const size_t blocks = (height + TransposeBlockSize - 1) / TransposeBlockSize;
+        const size_t begin = std::min(height, blocks * block / blocksCount * TransposeBlockSize);
+        const size_t end = std::min(height, blocks * (block + 1) / blocksCount * TransposeBlockSize);
+        TransposeRows<Image::PixelSize>(m_image.GetRowData(0), m_image.GetStride(), image.GetRowData(0), image.GetStride(), width, begin, end);
+        TransposeRows<sizeof(double)>(reinterpret_cast<const uint8_t *>(m_energy.GetRow(0)), m_energy.m_stride * sizeof(double), reinterpret_cast<uint8_t *>(energy.GetRow(0)), energy.m_stride * sizeof(double), width, begin, end);
+    });
+    m_image = std::move(image);
+    m_energy = std::move(energy);
+    m_transposed = transposed;
+}
+
+void SeamCarver::Run(size_t count, const std::function<void(size_t)> & task) const
+{
+    if (m_workers) {
+        m_workers->Run(count, task);
+    }
+    else {
+        for (size_t id = 0; id < count; id++) {
+            task(id);
+        }
+    }
+}
+
+void SeamCarver::RunWavefront(size_t rows, size_t width, const std::function<void(size_t, size_t, size_t)> & computeRow) const
+{
+    const size_t blocksCount = GetWavefrontBlocksCount(width);
+    if (blocksCount <= 1) {
+        for (size_t i = 1; i < rows; i++) {
+            computeRow(i, 0, width);
+        }
+        return;
+    }
+    std::vector<size_t> bounds(blocksCount + 1);
+    for (size_t block = 0; block <= blocksCount; block++) {
+        bounds[block] = width * block / blocksCount;
+    }
+    const size_t band = GetWavefrontBand(width);
+    for (size_t first = 1; first < rows; first += band) {
+        const size_t last = std::min(rows, first + band);
+        Run(blocksCount, [&](size_t block) {
+            for (size_t i = first; i < last; i++) {
+                const size_t shrink = i - first;
+                const size_t begin = block == 0 ? 0 : bounds[block] + shrink;
+                const size_t end = block + 1 == blocksCount ? width : bounds[block + 1] - shrink;
+                computeRow(i, begin, end);
+            }
+        });
+        Run(blocksCount - 1, [&](size_t boundary) {
+            const size_t middle = bounds[boundary + 1];
+            for (size_t i = first + 1; i < last; i++) {
+                computeRow(i, middle - (i - first), middle + (i - first));
+            }
+        });
+    }
+}
+
+size_t SeamCarver::GetWavefrontBlocksCount(size_t width) const
 {
-    if (GetImageHeight() == 0 || GetImageWidth() == 0) {
+    return m_workers ? std::max<size_t>(1, std::min(m_workers->GetThreadsCount(), width / MinBlockWidth)) : 1;
+}
+
+size_t SeamCarver::GetWavefrontBand(size_t width) const
+{
+    const size_t blocksCount = GetWavefrontBlocksCount(width);
+    // trapezoids of the narrowest block stay non-empty
+    return blocksCount == 1 ? 1 : width / blocksCount / 2;
+}
+
+SeamCarver::Seam SeamCarver::FindSeam() const
+{
+    std::lock_guard lock(m_search.m_mutex);
+    const double * costs = CalculateSeamCosts(m_search);
+    if (costs == nullptr) {
         return Seam();
     }
-    size_t width = transposed ? energy.GetHeight() : energy.GetWidth();
-    size_t height = transposed ? energy.GetWidth() : energy.GetHeight();
-    std::vector<std::vector<double>> dp(width, std::vector<double>(height));
-    std::vector<std::vector<size_t>> path(width, std::vector<size_t>(height));
+    return TraceSeam(m_search, std::min_element(costs, costs + m_image.GetWidth() - m_gapSize) - costs);
+}
+
+std::vector<SeamCarver::Seam> SeamCarver::FindSeams(size_t count, double tolerance) const
+{
+    std::lock_guard lock(m_search.m_mutex);
+    const double * costs = CalculateSeamCosts(m_search);
+    if (costs == nullptr || count == 0) {
+        return {};
+    }
+    const size_t width = m_image.GetHeight();
+    const size_t height = m_image.GetWidth() - m_gapSize;
+    const auto getEnergy = [this](size_t i, size_t g) {
+        return m_energy.Get(GetPhysicalColumn(g, i), i);
+    };
+    // ends of the seams from the cheapest one, first of the equal ones
+    // is the one FindSeam() takes
+    std::vector<size_t> ends(height);
     for (size_t g = 0; g < height; g++) {
-        dp[0][g] = transposed ? energy.Get(g, 0) : energy.Get(0, g);
+        ends[g] = g;
     }
-    for (size_t i = 1; i < width; i++) {
-        for (size_t g = 0; g < height; g++) {
-            auto val = std::min_element(dp[i - 1].begin() + (g == 0 ? g : g - 1), dp[i - 1].begin() + (g == height - 1 ? g : g + 1) + 1);
-            path[i][g] = val - dp[i - 1].begin();
-            dp[i][g] = *val + (transposed ? energy.Get(g, i) : energy.Get(i, g));
+    std::stable_sort(ends.begin(), ends.end(), [costs](size_t left, size_t right) {
+        return costs[left] < costs[right];
+    });
+    const double maxCost = costs[ends[0]] * (1 + tolerance);
+
+    std::vector<Seam> seams = {TraceSeam(m_search, ends[0])};
+    // seams taken by their positions in the last row, a new one has to stay
+    // between its neighbours from there in every row
+    std::vector<size_t> order = {0};
+    for (size_t id = 1; id < height && seams.size() < count && costs[ends[id]] <= maxCost; id++) {
+        const size_t end = ends[id];
+        const auto next = std::lower_bound(order.begin(), order.end(), end, [&seams, width](size_t seam, size_t position) {
+            return seams[seam][width - 1] < position;
+        });
+        const Seam * left = next == order.begin() ? nullptr : &seams[*(next - 1)];
+        const Seam * right = next == order.end() ? nullptr : &seams[*next];
+        if (right != nullptr && (*right)[width - 1] == end) {
+            continue;
+        }
+        Seam seam(width);
+        seam[width - 1] = end;
+        double cost = getEnergy(width - 1, end);
+        for (size_t w = width - 1; w > 0 && cost <= maxCost; w--) {
+            const size_t pos = seam[w];
+            // cells [first, last) of the previous row next to the pixel and between the neighbours
+            const size_t first = std::max(pos == 0 ? 0 : pos - 1, left == nullptr ? 0 : (*left)[w - 1] + 1);
+            const size_t last = std::min({pos + 2, height, right == nullptr ? height : (*right)[w - 1]});
+            size_t best = pos + m_search.m_moves[w * height + pos];
+            if (best < first || best >= last) {
+                best = first;
+                for (size_t g = first + 1; g < last; g++) {
+                    if (getEnergy(w - 1, g) < getEnergy(w - 1, best)) {
+                        best = g;
+                    }
+                }
+            }
+            // no way between the neighbours
+            cost = first < last ? cost + getEnergy(w - 1, best) : maxCost + 1;
+            seam[w - 1] = best;
         }
+        if (cost <= maxCost) {
+            order.insert(next, seams.size());
+            seams.push_back(std::move(seam));
+        }
+    }
+    return seams;
+}
+
+const double * SeamCarver::CalculateSeamCosts(SeamSearch & search) const
+{
+    // seam crosses the rows of the buffers, g is the position in a row
+    const size_t width = m_image.GetHeight();
+    const size_t height = m_image.GetWidth() - m_gapSize;
+    if (width == 0 || height == 0) {
+        return nullptr;
+    }
+    const size_t ringSize = GetWavefrontBand(height) + 1;
+    search.m_costs.resize(ringSize * height);
+    search.m_moves.resize(width * height);
+    const auto getCosts = [&search, ringSize, height](size_t i) {
+        return search.m_costs.data() + i % ringSize * height;
+    };
+    // cells of a row after its gap are m_gapSize further in the energy map
+    const auto getEnergyRow = [this, height](size_t i, size_t & gap) {
+        gap = m_gapSize == 0 ? height : m_gaps[i];
+        return m_energy.GetRow(i);
+    };
+    size_t firstGap;
+    const double * firstEnergy = getEnergyRow(0, firstGap);
+    double * firstCosts = getCosts(0);
+    for (size_t g = 0; g < height; g++) {
+        firstCosts[g] = firstEnergy[g < firstGap ? g : g + m_gapSize];
     }
+    RunWavefront(width, height, [&](size_t i, size_t begin, size_t end) {
+        size_t gap;
+        const double * energy = getEnergyRow(i, gap);
+        const double * previous = getCosts(i - 1);
+        double * costs = getCosts(i);
+        int8_t * moves = search.m_moves.data() + i * height;
+        for (size_t g = begin; g < end; g++) {
+            const double * val = std::min_element(previous + (g == 0 ? g : g - 1), previous + (g == height - 1 ? g : g + 1) + 1);
+            moves[g] = static_cast<int8_t>(val - (previous + g));
+            costs[g] = *val + energy[g < gap ? g : g + m_gapSize];
+        }
+    });
+    return getCosts(width - 1);
+}
 
-    size_t pos = std::min_element(dp[width - 1].begin(), dp[width - 1].end()) - dp[width - 1].begin();
-    Seam answer = {pos};
+SeamCarver::Seam SeamCarver::TraceSeam(const SeamSearch & search, size_t position) const
+{
+    const size_t width = m_image.GetHeight();
+    const size_t height = m_image.GetWidth() - m_gapSize;
+    Seam answer(width);
+    answer[width - 1] = position;
     for (size_t w = width - 1; w > 0; w--) {
-        pos = path[w][pos];
-        answer.push_back(pos);
+        position += search.m_moves[w * height + position];
+        answer[w - 1] = position;
     }
-    std::reverse(answer.begin(), answer.end());
     return answer;
 }
 
+double SeamCarver::CalculateEnergy(size_t x, size_t y) const
+{
+    const size_t width = m_image.GetWidth() - m_gapSize;
+    const size_t height = m_image.GetHeight();
+    const size_t left = (x == 0 ? width : x) - 1;
+    const size_t right = x + 1 == width ? 0 : x + 1;
+    const size_t up = (y == 0 ? height : y) - 1;
+    const size_t down = y + 1 == height ? 0 : y + 1;
+    return CalculatePixelEnergy(GetPixelData(left, y), GetPixelData(right, y), GetPixelData(x, up), GetPixelData(x, down));
+}
+
+size_t SeamCarver::GetPhysicalColumn(size_t x, size_t y) const
+{
+    return m_gapSize != 0 && x >= m_gaps[y] ? x + m_gapSize : x;
+}
+
+const uint8_t * SeamCarver::GetPixelData(size_t x, size_t y) const
+{
+    return m_image.GetRowData(y) + GetPhysicalColumn(x, y) * Image::PixelSize;
+}
+
+void SeamCarver::UpdateEnergy(size_t x, size_t y)
+{
+    m_energy.Set(GetPhysicalColumn(x, y), y, CalculateEnergy(x, y));
+}
+
 void SeamCarver::RemoveHorizontalSeam(const Seam & seam)
 {
-    for (size_t i = 0; i < GetImageWidth(); i++) {
-        m_image.m_table[i].erase(m_image.m_table[i].begin() + seam[i]);
+    SetTransposed(true);
+    RemoveSeam(seam);
+}
+
+void SeamCarver::RemoveVerticalSeam(const Seam & seam)
+{
+    SetTransposed(false);
+    RemoveSeam(seam);
+}
+
+void SeamCarver::RemoveHorizontalSeams(const std::vector<Seam> & seams)
+{
+    SetTransposed(true);
+    RemoveSeams(seams);
+}
+
+void SeamCarver::RemoveVerticalSeams(const std::vector<Seam> & seams)
+{
+    SetTransposed(false);
+    RemoveSeams(seams);
+}
+
+void SeamCarver::RemoveSeams(const std::vector<Seam> & seams)
+{
+    // seams don't cross, removed from the last one in a row the rest keep their positions
+    std::vector<const Seam *> order;
+    for (const auto & seam : seams) {
+        order.push_back(&seam);
     }
-    if (GetImageHeight() == 0) {
-        m_image.m_table.clear();
+    std::sort(order.begin(), order.end(), [](const Seam * left, const Seam * right) {
+        return left->front() > right->front();
+    });
+    for (const Seam * seam : order) {
+        RemoveSeam(*seam);
     }
 }
 
-void SeamCarver::RemoveVerticalSeam(const Seam & seam)
+void SeamCarver::RemoveSeam(const Seam & seam)
 {
-    for (size_t i = 0; i < GetImageHeight(); i++) {
-        for (size_t g = seam[i] + 1; g < GetImageWidth(); g++) {
-            m_image.m_table[g - 1][i] = m_image.m_table[g][i];
+    m_outputValid = false;
+    m_gaps.resize(m_image.GetHeight());
+    for (size_t i = 0; i < m_image.GetHeight(); i++) {
+        MoveGap(i, seam[i]);
+    }
+    m_gapSize++;
+    if (m_image.GetWidth() == m_gapSize) {
+        Compact();
+        return;
+    }
+    UpdateEnergyAfterSeam(seam);
+}
+
+void SeamCarver::MoveGap(size_t row, size_t position)
+{
+    size_t & gap = m_gaps[row];
+    if (m_gapSize != 0) {
+        uint8_t * pixels = m_image.GetRowData(row);
+        double * energy = m_energy.GetRow(row);
+        if (position >= gap) {
+            std::memmove(pixels + gap * Image::PixelSize, pixels + (gap + m_gapSize) * Image::PixelSize, (position - gap) * Image::PixelSize);
+            std::copy(energy + gap + m_gapSize, energy + position + m_gapSize, energy + gap);
+        }
+        else {
+            std::memmove(pixels + (position + 1 + m_gapSize) * Image::PixelSize, pixels + (position + 1) * Image::PixelSize, (gap - position - 1) * Image::PixelSize);
+            std::copy_backward(energy + position + 1, energy + gap, energy + gap + m_gapSize);
         }
     }
-    if (!m_image.m_table.empty()) {
-        m_image.m_table.pop_back();
+    gap = position;
+}
+
+void SeamCarver::Compact() const
+{
+    if (m_gapSize == 0) {
+        return;
+    }
+    const size_t width = m_image.GetWidth();
+    const size_t height = m_image.GetHeight();
+    for (size_t i = 0; i < height; i++) {
+        const size_t gap = m_gaps[i];
+        uint8_t * pixels = m_image.GetRowData(i);
+        std::memmove(pixels + gap * Image::PixelSize, pixels + (gap + m_gapSize) * Image::PixelSize, (width - gap - m_gapSize) * Image::PixelSize);
+        double * energy = m_energy.GetRow(i);
+        std::copy(energy + gap + m_gapSize, energy + width, energy + gap);
+    }
+    m_image.Crop(width - m_gapSize, height);
+    m_energy.Crop(m_image.GetWidth(), m_image.GetHeight());
+    m_gapSize = 0;
+}
+
+void SeamCarver::UpdateEnergyAfterSeam(const Seam & seam)
+{
+    const size_t width = m_image.GetWidth() - m_gapSize;
+    const size_t height = m_image.GetHeight();
+    for (size_t i = 0; i < height; i++) {
+        // pixels from the left of the seam to the right of it in adjacent rows
+        // got new neighbours (for the first and the last rows seam in the other
+        // one may be far away)
+        const size_t up = seam[(i + height - 1) % height];
+        const size_t down = seam[(i + 1) % height];
+        const size_t first = std::min({seam[i], up, down});
+        const size_t last = std::max({seam[i], up, down});
+        for (size_t g = first + width - 1; g <= last + width; g++) {
+            UpdateEnergy(g % width, i);
+        }
     }
 }
@@ -0,0 +1,94 @@
+#include "WorkerPool.h"
+
+WorkerPool::WorkerPool(size_t threadsCount)
+{
+    for (size_t i = 1; i < threadsCount; i++) {
+        m_threads.emplace_back([this] {
+            Work();
+        });
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+    }
+    m_started.notify_all();
+    for (auto & thread : m_threads) {
+        thread.join();
+    }
+}
+
+size_t WorkerPool::GetThreadsCount() const
+{
+    return m_threads.size() + 1;
+}
+
+void WorkerPool::Run(size_t count, const std::function<void(size_t)> & task)
+{
+    if (m_threads.empty() || count <= 1) {
+        for (size_t id = 0; id < count; id++) {
+            task(id);
+        }
+        return;
+    }
+    std::lock_guard runLock(m_runMutex);
+    {
+        std::unique_lock lock(m_mutex);
+        // workers late for the previous batch have to leave it first
+        m_finished.wait(lock, [this] {
+            return m_active == 0;
+        });
+        m_task = &task;
+        m_count = count;
+        m_next = 0;
+        m_unfinished = count;
+        m_generation++;
+    }
+    m_started.notify_all();
+    RunTasks();
+    std::unique_lock lock(m_mutex);
+    m_finished.wait(lock, [this] {
+        return m_unfinished == 0 && m_active == 0;
+    });
+}
+
+void WorkerPool::Work()
+{
+    size_t generation = 0;
+    std::unique_lock lock(m_mutex);
+    while (true) {
+        m_started.wait(lock, [this, &generation] {
+            return m_stop || m_generation != generation;
+        });
+        if (m_stop) {
+            return;
+        }
+        generation = m_generation;
+        m_active++;
+        lock.unlock();
+        RunTasks();
+        lock.lock();
+        m_active--;
+        if (m_active == 0) {
+            m_finished.notify_all();
+        }
+    }
+}
+
+void WorkerPool::RunTasks()
+{
+    while (true) {
+        const size_t id = m_next++;
+        if (id >= m_count) {
+            return;
+        }
+        (*m_task)(id);
+        if (--m_unfinished == 0) {
+            std::lock_guard lock(m_mutex);
+            m_finished.notify_all();
+        }
+    }
+}
@@ -1,68 +1,110 @@
 #include "Image.h"
+#include "ImageIO.h"
+#include "RemovalOrder.h"
 #include "SeamCarver.h"
 
+#include <charconv>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 
 namespace {
-std::vector<std::vector<Image::Pixel>> ReadImageFromCSV(std::ifstream & input)
+// seam-carving --order image.csv order.txt
+void WriteRemovalOrder(const char * imageFilename, const char * orderFilename)
 {
-    size_t width, height;
-    input >> width >> height;
-    std::vector<std::vector<Image::Pixel>> table;
-    for (size_t columnId = 0; columnId < width; ++columnId) {
-        std::vector<Image::Pixel> column;
-        for (size_t rowId = 0; rowId < height; ++rowId) {
-            size_t red, green, blue;
-            input >> red >> green >> blue;
-            column.emplace_back(red, green, blue);
-        }
-        table.emplace_back(std::move(column));
+    const auto image = ReadImage(imageFilename);
+    if (!image) {
+        std::cout << "Can't read source file " << imageFilename << ". Verify that the file exists and is an image." << std::endl;
+        return;
     }
-    return table;
+    const RemovalOrder order(*image);
+    std::ofstream outputFile(orderFilename);
+    order.Write(outputFile);
+    std::cout << "Removal order of " << order.GetWidth() << "x" << order.GetHeight() << " image is written to " << orderFilename << "." << std::endl;
 }
-void WriteImageToCSV(const SeamCarver & carver, std::ofstream & output)
+
+// seam-carving --width W image.csv order.txt image_updated.csv
+void WriteRetargetedImage(size_t width, const char * imageFilename, const char * orderFilename, const char * outputFilename)
 {
-    const size_t width = carver.GetImageWidth();
-    const size_t height = carver.GetImageHeight();
-    output << width << " " << height << "\n";
-    const Image & image = carver.GetImage();
-    for (size_t columnId = 0; columnId < width; ++columnId) {
-        for (size_t rowId = 0; rowId < height; ++rowId) {
-            const Image::Pixel & pixel = image.GetPixel(columnId, rowId);
-            output << pixel.m_red << " " << pixel.m_green << " " << pixel.m_blue << std::endl;
-        }
+    const auto image = ReadImage(imageFilename);
+    std::ifstream orderFile(orderFilename);
+    if (!image || !orderFile.good()) {
+        std::cout << "Can't read source files " << imageFilename << " and " << orderFilename << ". Verify that the files exist." << std::endl;
+        return;
+    }
+    const RemovalOrder order(orderFile);
+    if (!order.IsValid()) {
+        std::cout << "Removal order " << orderFilename << " is malformed." << std::endl;
+        return;
     }
+    if (order.GetWidth() != image->GetWidth() || order.GetHeight() != image->GetHeight()) {
+        std::cout << "Removal order " << orderFilename << " doesn't match the image size." << std::endl;
+        return;
+    }
+    if (!WriteImage(order.Retarget(*image, width), outputFilename)) {
+        std::cout << "Can't write " << outputFilename << "." << std::endl;
+        return;
+    }
+    std::cout << "Updated image is written to " << outputFilename << "." << std::endl;
+}
+
+void PrintUsage()
+{
+    std::cout << "Provide filenames as arguments. See example below:\n";
+    std::cout << "seam-carving data/tower.csv data/tower_updated.csv\n";
+    std::cout << "Images can be in CSV, binary PPM or PAM (chosen by the extension for the output):\n";
+    std::cout << "seam-carving data/tower.ppm data/tower_updated.ppm" << std::endl;
+    std::cout << "Removal order of pixels can be saved once and used for any width:\n";
+    std::cout << "seam-carving --order data/tower.csv data/tower_order.txt\n";
+    std::cout << "seam-carving --width 300 data/tower.csv data/tower_order.txt data/tower_300.csv" << std::endl;
 }
 } // namespace
 
 int main(int argc, char * argv[])
 {
+    if (argc == 4 && std::strcmp(argv[1], "--order") == 0) {
+        WriteRemovalOrder(argv[2], argv[3]);
+        return 0;
+    }
+    if (argc == 6 && std::strcmp(argv[1], "--width") == 0) {
+        size_t width;
+        const char * end = argv[2] + std::strlen(argv[2]);
+        const auto [last, error] = std::from_chars(argv[2], end, width);
+        if (error != std::errc() || last != end) {
+            std::cout << "Width " << argv[2] << " isn't a number. ";
+            PrintUsage();
+            return 0;
+        }
+        WriteRetargetedImage(width, argv[3], argv[4], argv[5]);
+        return 0;
+    }
     // Check command line arguments
     const size_t expectedAmountOfArgs = 3;
     if (argc != expectedAmountOfArgs) {
-        std::cout << "Wrong amount of arguments. Provide filenames as arguments. See example below:\n";
-        std::cout << "seam-carving data/tower.csv data/tower_updated.csv" << std::endl;
+        std::cout << "Wrong amount of arguments. ";
+        PrintUsage();
         return 0;
     }
-    // Check csv file
-    std::ifstream inputFile(argv[1]);
-    if (!inputFile.good()) {
-        std::cout << "Can't open source file " << argv[1] << ". Verify that the file exists." << std::endl;
+    // Check source file
+    auto imageSource = ReadImage(argv[1]);
+    if (!imageSource) {
+        std::cout << "Can't read source file " << argv[1] << ". Verify that the file exists and is an image." << std::endl;
     }
     else {
-        auto imageSource = ReadImageFromCSV(inputFile);
-        SeamCarver carver(std::move(imageSource));
+        SeamCarver carver(std::move(*imageSource));
         std::cout << "Image: " << carver.GetImageWidth() << "x" << carver.GetImageHeight() << std::endl;
         const size_t pixelsToDelete = 150;
         for (size_t i = 0; i < pixelsToDelete; ++i) {
             std::vector<size_t> seam = carver.FindVerticalSeam();
             carver.RemoveVerticalSeam(seam);
-            std::cout << "width = " << carver.GetImageWidth() << ", height = " << carver.GetImageHeight() << std::endl;
+            std::cout << "width = " << carver.GetImageWidth() << ", height = " << carver.GetImageHeight() << "\n";
+        }
+        if (!WriteImage(carver.GetImage(), argv[2])) {
+            std::cout << "Can't write " << argv[2] << "." << std::endl;
+        }
+        else {
+            std::cout << "Updated image is written to " << argv[2] << "." << std::endl;
         }
-        std::ofstream outputFile(argv[2]);
-        WriteImageToCSV(carver, outputFile);
-        std::cout << "Updated image is written to " << argv[2] << "." << std::endl;
     }
     return 0;
 }
\ No newline at end of file
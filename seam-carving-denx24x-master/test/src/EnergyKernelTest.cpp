@@ -0,0 +1,80 @@
+#include "EnergyKernel.h"
+#include "TestImages.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+namespace {
+
+::testing::AssertionResult RowsMatchScalar(const Image & image, bool squared)
+{
+    std::vector<double> energy(image.GetWidth());
+    for (size_t y = 0; y < image.GetHeight(); y++) {
+        CalculateRowEnergy(image, y, energy.data(), squared);
+        for (size_t x = 0; x < image.GetWidth(); x++) {
+            const double expected = CalculatePixelEnergy(image, x, y, squared);
+            if (energy[x] != expected) {
+                return ::testing::AssertionFailure() << "energy of (" << x << ", " << y << ") of " << image.GetWidth() << "x" << image.GetHeight()
+                                                     << " image is " << energy[x] << " instead of " << expected;
+            }
+        }
+    }
+    return ::testing::AssertionSuccess();
+}
+
+// widths around vector sizes and the chunk of gradients computed at once
+const size_t Widths[] = {1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 32, 33, 255, 256, 257, 258, 600};
+
+} // anonymous namespace
+
+TEST(EnergyKernelTest, pixel_energy)
+{
+    const Image image({{{0, 0, 0}, {10, 20, 30}, {0, 0, 0}}, {{1, 2, 3}, {0, 0, 0}, {5, 5, 5}}, {{4, 4, 4}, {0, 0, 0}, {255, 255, 255}}});
+    // left (0, 1) and right (2, 1) differ by (10, 20, 30),
+    // up (1, 0) and down (1, 2) by (4, 3, 2)
+    EXPECT_EQ(1429, CalculatePixelEnergy(image, 1, 1, true));
+    EXPECT_DOUBLE_EQ(std::sqrt(1429), CalculatePixelEnergy(image, 1, 1));
+    // neighbours wrap around the borders
+    const uint8_t * left = image.GetRowData(0) + 2 * Image::PixelSize;
+    const uint8_t * right = image.GetRowData(0) + 1 * Image::PixelSize;
+    const uint8_t * up = image.GetRowData(2);
+    const uint8_t * down = image.GetRowData(1);
+    EXPECT_EQ(CalculatePixelEnergy(image, 0, 0, true), CalculatePixelEnergy(left, right, up, down, true));
+}
+
+TEST(EnergyKernelTest, random_rows)
+{
+    for (const size_t width : Widths) {
+        for (const size_t height : {1, 2, 3, 5}) {
+            const Image image = RandomImage(width, height, static_cast<unsigned>(width * 10 + height));
+            ASSERT_TRUE(RowsMatchScalar(image, false));
+            ASSERT_TRUE(RowsMatchScalar(image, true));
+        }
+    }
+}
+
+TEST(EnergyKernelTest, extreme_differences)
+{
+    // black and white stripes give the largest gradients in both directions
+    for (const size_t width : Widths) {
+        Image image(width, 4);
+        for (size_t y = 0; y < image.GetHeight(); y++) {
+            for (size_t x = 0; x < image.GetWidth(); x++) {
+                const int value = (x + y) % 2 == 0 ? 255 : 0;
+                image.SetPixel(x, y, Image::Pixel(value, 255 - value, value));
+            }
+        }
+        ASSERT_TRUE(RowsMatchScalar(image, true));
+    }
+}
+
+TEST(EnergyKernelTest, cropped_rows)
+{
+    for (const size_t width : Widths) {
+        Image image = RandomImage(width + 5, 6, static_cast<unsigned>(width));
+        image.Crop(width, 4);
+        ASSERT_TRUE(RowsMatchScalar(image, false));
+    }
+}
@@ -0,0 +1,61 @@
+#include "EnergyKernel.h"
+#include "SeamCarver.h"
+#include "TestImages.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+// energy kept by the carver has to match energy computed from scratch
+::testing::AssertionResult EnergyIsUpToDate(const SeamCarver & carver)
+{
+    const Image & image = carver.GetImage();
+    for (size_t y = 0; y < image.GetHeight(); y++) {
+        for (size_t x = 0; x < image.GetWidth(); x++) {
+            const double expected = CalculatePixelEnergy(image, x, y);
+            const double actual = carver.GetPixelEnergy(x, y);
+            if (expected != actual) {
+                return ::testing::AssertionFailure() << "energy of (" << x << ", " << y << ") is " << actual << " instead of " << expected;
+            }
+        }
+    }
+    return ::testing::AssertionSuccess();
+}
+
+} // anonymous namespace
+
+TEST(EnergyMapTest, vertical_seams)
+{
+    SeamCarver carver(RandomImage(40, 30, 1), 1);
+    ASSERT_TRUE(EnergyIsUpToDate(carver));
+    while (carver.GetImageWidth() > 1) {
+        carver.RemoveVerticalSeam(carver.FindVerticalSeam());
+        ASSERT_TRUE(EnergyIsUpToDate(carver)) << "width " << carver.GetImageWidth();
+    }
+}
+
+TEST(EnergyMapTest, horizontal_seams)
+{
+    SeamCarver carver(RandomImage(30, 40, 2), 1);
+    while (carver.GetImageHeight() > 1) {
+        carver.RemoveHorizontalSeam(carver.FindHorizontalSeam());
+        ASSERT_TRUE(EnergyIsUpToDate(carver)) << "height " << carver.GetImageHeight();
+    }
+}
+
+TEST(EnergyMapTest, alternating_seams)
+{
+    // few levels give many pixels of equal energy
+    SeamCarver carver(RandomImage(37, 29, 3, 4), 1);
+    for (size_t i = 0; i < 20; i++) {
+        if (i % 3 == 0) {
+            carver.RemoveHorizontalSeam(carver.FindHorizontalSeam());
+        }
+        else {
+            carver.RemoveVerticalSeam(carver.FindVerticalSeam());
+        }
+        ASSERT_TRUE(EnergyIsUpToDate(carver)) << "step " << i;
+    }
+    EXPECT_EQ(24, carver.GetImageWidth());
+    EXPECT_EQ(22, carver.GetImageHeight());
+}
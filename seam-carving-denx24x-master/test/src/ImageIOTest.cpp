@@ -0,0 +1,104 @@
+#include "ImageIO.h"
+#include "TestImages.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+namespace {
+
+std::string TempPath(const std::string & name)
+{
+    return ::testing::TempDir() + name;
+}
+
+std::string WriteFile(const std::string & name, const std::string & content)
+{
+    const std::string path = TempPath(name);
+    std::ofstream(path, std::ios::binary) << content;
+    return path;
+}
+
+::testing::AssertionResult RoundTrip(const Image & image, const std::string & name)
+{
+    const std::string path = TempPath(name);
+    if (!WriteImage(image, path)) {
+        return ::testing::AssertionFailure() << "can't write " << path;
+    }
+    const auto read = ReadImage(path);
+    std::remove(path.c_str());
+    if (!read) {
+        return ::testing::AssertionFailure() << "can't read " << path;
+    }
+    return SameImages(image, *read);
+}
+
+} // anonymous namespace
+
+TEST(ImageIOTest, round_trip)
+{
+    const Image image = RandomImage(37, 23, 1);
+    for (const std::string name : {"image.ppm", "image.pam", "image.csv", "image.PPM", "image.txt"}) {
+        EXPECT_TRUE(RoundTrip(image, name)) << name;
+    }
+}
+
+TEST(ImageIOTest, cropped_and_empty_images)
+{
+    Image cropped = RandomImage(20, 10, 2);
+    cropped.Crop(13, 7);
+    const Image empty(0, 0);
+    for (const std::string name : {"image.ppm", "image.pam", "image.csv"}) {
+        EXPECT_TRUE(RoundTrip(cropped, name)) << name;
+        EXPECT_TRUE(RoundTrip(empty, name)) << name;
+    }
+}
+
+TEST(ImageIOTest, large_csv)
+{
+    // takes several chunks of the write buffer
+    EXPECT_TRUE(RoundTrip(RandomImage(400, 300, 3), "large.csv"));
+}
+
+TEST(ImageIOTest, format_is_detected_by_content)
+{
+    const Image image = RandomImage(5, 4, 4);
+    const std::string path = TempPath("binary.ppm");
+    ASSERT_TRUE(WriteImage(image, path));
+    const std::string renamed = TempPath("binary.csv");
+    ASSERT_EQ(0, std::rename(path.c_str(), renamed.c_str()));
+    const auto read = ReadImage(renamed);
+    ASSERT_TRUE(read);
+    EXPECT_TRUE(SameImages(image, *read));
+}
+
+TEST(ImageIOTest, csv_is_column_by_column)
+{
+    const auto read = ReadImage(WriteFile("columns.csv", "2 1\n1 2 3\n4 5 6\n"));
+    ASSERT_TRUE(read);
+    EXPECT_EQ(2, read->GetWidth());
+    EXPECT_EQ(1, read->GetHeight());
+    EXPECT_EQ(4, read->GetPixel(1, 0).m_red);
+}
+
+TEST(ImageIOTest, malformed_files)
+{
+    EXPECT_FALSE(ReadImage(TempPath("missing.ppm")));
+    EXPECT_FALSE(ReadImage(WriteFile("empty.csv", "")));
+    EXPECT_FALSE(ReadImage(WriteFile("truncated.csv", "2 2\n1 2 3\n4 5 6\n")));
+    EXPECT_FALSE(ReadImage(WriteFile("huge.csv", "1000000000 1000000000\n1 2 3\n")));
+    EXPECT_FALSE(ReadImage(WriteFile("truncated.ppm", "P6\n2 2\n255\n123456789")));
+    EXPECT_FALSE(ReadImage(WriteFile("maxval.ppm", "P6\n1 1\n65535\n123456")));
+    EXPECT_FALSE(ReadImage(WriteFile("header.ppm", "P6\n1 1\n255")));
+    EXPECT_FALSE(ReadImage(WriteFile("depth.pam", "P7\nWIDTH 1\nHEIGHT 1\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n1234")));
+    EXPECT_FALSE(ReadImage(WriteFile("unfinished.pam", "P7\nWIDTH 1\nHEIGHT 1\nDEPTH 3\nMAXVAL 255\n")));
+    EXPECT_TRUE(ReadImage(WriteFile("valid.pam", "P7\nWIDTH 1\nHEIGHT 1\nDEPTH 3\nMAXVAL 255\nTUPLTYPE RGB\nENDHDR\n123")));
+}
+
+TEST(ImageIOTest, unwritable_path)
+{
+    EXPECT_FALSE(WriteImage(RandomImage(2, 2, 5), TempPath("no_such_dir/image.ppm")));
+    EXPECT_FALSE(WriteImage(RandomImage(2, 2, 5), TempPath("no_such_dir/image.csv")));
+}
@@ -0,0 +1,78 @@
+#include "Image.h"
+#include "TestImages.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+TEST(ImageTest, table_of_columns)
+{
+    const Image image({{{1, 2, 3}, {4, 5, 6}}, {{7, 8, 9}, {10, 11, 12}}, {{13, 14, 15}, {16, 17, 18}}});
+    EXPECT_EQ(3, image.GetWidth());
+    EXPECT_EQ(2, image.GetHeight());
+    EXPECT_EQ(3 * Image::PixelSize, image.GetStride());
+    EXPECT_EQ(16, image.GetPixel(2, 1).m_red);
+    // pixels of a row are packed together
+    const std::vector<uint8_t> row(image.GetRowData(1), image.GetRowData(1) + image.GetStride());
+    EXPECT_EQ((std::vector<uint8_t>{4, 5, 6, 10, 11, 12, 16, 17, 18}), row);
+    EXPECT_TRUE(SameImages(image, Image(ToTable(image))));
+}
+
+TEST(ImageTest, rows_and_columns)
+{
+    const Image image = RandomImage(5, 4, 1);
+    const Image::View row = image.GetRow(2);
+    const Image::View column = image.GetColumn(3);
+    ASSERT_EQ(5, row.size());
+    ASSERT_EQ(4, column.size());
+    for (size_t x = 0; x < row.size(); x++) {
+        EXPECT_EQ(image.GetPixel(x, 2).m_green, row[x].m_green);
+    }
+    for (size_t y = 0; y < column.size(); y++) {
+        EXPECT_EQ(image.GetPixel(3, y).m_blue, column[y].m_blue);
+    }
+    EXPECT_EQ(4, image.GetColumnIdNormalized(-1));
+    EXPECT_EQ(0, image.GetRowIdNormalized(4));
+}
+
+TEST(ImageTest, set_pixel)
+{
+    Image image(2, 2);
+    EXPECT_EQ(0, image.GetPixel(1, 1).m_red);
+    image.SetPixel(1, 0, Image::Pixel(255, 128, 0));
+    EXPECT_EQ(255, image.GetPixel(1, 0).m_red);
+    EXPECT_EQ(128, image.GetPixel(1, 0).m_green);
+    EXPECT_EQ(0, image.GetPixel(0, 1).m_green);
+    EXPECT_EQ(255 * 255 + 128 * 128, image.GetPixel(1, 0).GetSumOfSquaresOfComponents());
+    EXPECT_EQ(255, image.GetPixel(1, 0).GetDifference(image.GetPixel(0, 0)).m_red);
+}
+
+TEST(ImageTest, crop_keeps_top_left)
+{
+    const Image original = RandomImage(6, 5, 2);
+    Image image = original;
+    image.Crop(4, 3);
+    EXPECT_EQ(4, image.GetWidth());
+    EXPECT_EQ(3, image.GetHeight());
+    // rows keep their place in the buffer
+    EXPECT_EQ(original.GetStride(), image.GetStride());
+    for (size_t y = 0; y < 3; y++) {
+        for (size_t x = 0; x < 4; x++) {
+            EXPECT_EQ(original.GetPixel(x, y).m_red, image.GetPixel(x, y).m_red);
+        }
+    }
+}
+
+TEST(ImageTest, empty_images)
+{
+    const Image noRows(3, 0);
+    EXPECT_EQ(0, noRows.GetWidth());
+    EXPECT_EQ(0, noRows.GetHeight());
+    const Image noColumns(std::vector<std::vector<Image::Pixel>>(0));
+    EXPECT_EQ(0, noColumns.GetWidth());
+    EXPECT_EQ(0, noColumns.GetHeight());
+    Image cropped = RandomImage(3, 3, 3);
+    cropped.Crop(0, 2);
+    EXPECT_EQ(0, cropped.GetWidth());
+    EXPECT_EQ(0, cropped.GetHeight());
+}
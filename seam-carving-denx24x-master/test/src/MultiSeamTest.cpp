@@ -0,0 +1,125 @@
+#include "EnergyKernel.h"
+#include "SeamCarver.h"
+#include "TestImages.h"
+
+#include <gtest/gtest.h>
+
+#include <set>
+#include <vector>
+
+namespace {
+
+using Seam = std::vector<size_t>;
+
+double GetVerticalSeamCost(const Image & image, const Seam & seam)
+{
+    double cost = 0;
+    for (size_t y = 0; y < seam.size(); y++) {
+        cost += CalculatePixelEnergy(image, seam[y], y);
+    }
+    return cost;
+}
+
+::testing::AssertionResult ApartAndConnected(const std::vector<Seam> & seams, size_t width)
+{
+    for (size_t id = 0; id < seams.size(); id++) {
+        const Seam & seam = seams[id];
+        for (size_t y = 0; y < seam.size(); y++) {
+            if (seam[y] >= width || (y > 0 && (seam[y] > seam[y - 1] + 1 || seam[y - 1] > seam[y] + 1))) {
+                return ::testing::AssertionFailure() << "seam " << id << " is broken at " << y;
+            }
+        }
+        for (size_t other = 0; other < id; other++) {
+            const bool left = seams[other][0] < seam[0];
+            for (size_t y = 0; y < seam.size(); y++) {
+                if (seams[other][y] == seam[y] || (seams[other][y] < seam[y]) != left) {
+                    return ::testing::AssertionFailure() << "seams " << other << " and " << id << " meet at " << y;
+                }
+            }
+        }
+    }
+    return ::testing::AssertionSuccess();
+}
+
+// removes pixels of all the seams at once
+Image RemoveVerticalNaively(const Image & image, const std::vector<Seam> & seams)
+{
+    const auto table = ToTable(image);
+    std::vector<std::vector<Image::Pixel>> result(image.GetWidth() - seams.size());
+    for (size_t y = 0; y < image.GetHeight(); y++) {
+        std::set<size_t> removed;
+        for (const Seam & seam : seams) {
+            removed.insert(seam[y]);
+        }
+        for (size_t x = 0, column = 0; x < image.GetWidth(); x++) {
+            if (removed.count(x) == 0) {
+                result[column++].push_back(table[x][y]);
+            }
+        }
+    }
+    return Image(result);
+}
+
+} // anonymous namespace
+
+TEST(MultiSeamTest, seams_are_apart)
+{
+    const Image image = RandomImage(60, 40, 1);
+    const SeamCarver carver(image, 1);
+    const auto seams = carver.FindVerticalSeams(20, 1.0);
+    ASSERT_FALSE(seams.empty());
+    EXPECT_LE(seams.size(), 20);
+    EXPECT_EQ(carver.FindVerticalSeam(), seams[0]);
+    EXPECT_TRUE(ApartAndConnected(seams, image.GetWidth()));
+    const auto horizontal = carver.FindHorizontalSeams(20, 1.0);
+    ASSERT_FALSE(horizontal.empty());
+    EXPECT_EQ(carver.FindHorizontalSeam(), horizontal[0]);
+    EXPECT_TRUE(ApartAndConnected(horizontal, image.GetHeight()));
+}
+
+TEST(MultiSeamTest, tolerance_bounds_cost)
+{
+    const Image image = RandomImage(60, 40, 2);
+    const SeamCarver carver(image, 1);
+    size_t previousCount = 0;
+    for (const double tolerance : {0.0, 0.05, 0.2, 1.0, 100.0}) {
+        const auto seams = carver.FindVerticalSeams(image.GetWidth(), tolerance);
+        const double best = GetVerticalSeamCost(image, seams[0]);
+        for (const Seam & seam : seams) {
+            EXPECT_LE(GetVerticalSeamCost(image, seam), best * (1 + tolerance) * (1 + 1e-9)) << "tolerance " << tolerance;
+        }
+        EXPECT_GE(seams.size(), previousCount);
+        previousCount = seams.size();
+    }
+    EXPECT_GT(previousCount, 1);
+}
+
+TEST(MultiSeamTest, edge_cases)
+{
+    const SeamCarver carver(RandomImage(5, 4, 3), 1);
+    EXPECT_TRUE(carver.FindVerticalSeams(0).empty());
+    EXPECT_LE(carver.FindVerticalSeams(100, 100.0).size(), 5);
+    const SeamCarver empty(Image(0, 0), 1);
+    EXPECT_TRUE(empty.FindVerticalSeams(3).empty());
+}
+
+TEST(MultiSeamTest, removal_at_once)
+{
+    Image expected = RandomImage(50, 30, 4, 8);
+    SeamCarver carver(expected, 1);
+    while (expected.GetWidth() > 10) {
+        const auto seams = carver.FindVerticalSeams(5, 0.5);
+        expected = RemoveVerticalNaively(expected, seams);
+        carver.RemoveVerticalSeams(seams);
+        ASSERT_TRUE(SameImages(expected, carver.GetImage())) << "width " << expected.GetWidth();
+        for (size_t y = 0; y < expected.GetHeight(); y++) {
+            for (size_t x = 0; x < expected.GetWidth(); x++) {
+                ASSERT_EQ(CalculatePixelEnergy(expected, x, y), carver.GetPixelEnergy(x, y));
+            }
+        }
+    }
+    const auto horizontal = carver.FindHorizontalSeams(5, 0.5);
+    const Image transposed = Transpose(RemoveVerticalNaively(Transpose(expected), horizontal));
+    carver.RemoveHorizontalSeams(horizontal);
+    EXPECT_TRUE(SameImages(transposed, carver.GetImage()));
+}
@@ -0,0 +1,102 @@
+#include "SeamCarver.h"
+#include "TestImages.h"
+#include "WorkerPool.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// large enough to be split between threads
+Image LargeImage(unsigned seed, int levels = 256)
+{
+    return RandomImage(320, 240, seed, levels);
+}
+
+} // anonymous namespace
+
+TEST(WorkerPoolTest, runs_every_task_once)
+{
+    WorkerPool pool(4);
+    EXPECT_EQ(4, pool.GetThreadsCount());
+    std::vector<std::atomic<int>> runs(1000);
+    for (size_t batch = 0; batch < 10; batch++) {
+        pool.Run(runs.size(), [&runs](size_t id) {
+            runs[id]++;
+        });
+    }
+    for (const auto & count : runs) {
+        EXPECT_EQ(10, count);
+    }
+}
+
+TEST(WorkerPoolTest, batches_from_several_threads)
+{
+    WorkerPool pool(3);
+    std::atomic<int> done = 0;
+    std::vector<std::thread> callers;
+    for (size_t i = 0; i < 4; i++) {
+        callers.emplace_back([&pool, &done] {
+            for (size_t batch = 0; batch < 50; batch++) {
+                pool.Run(7, [&done](size_t) {
+                    done++;
+                });
+            }
+        });
+    }
+    for (auto & caller : callers) {
+        caller.join();
+    }
+    EXPECT_EQ(4 * 50 * 7, done);
+}
+
+TEST(ParallelSeamsTest, same_as_single_thread)
+{
+    for (const int levels : {256, 3}) {
+        const Image image = LargeImage(1, levels);
+        SeamCarver single(image, 1);
+        SeamCarver parallel(image, 4);
+        SeamCarver odd(image, 3);
+        for (size_t i = 0; i < 20; i++) {
+            const auto vertical = single.FindVerticalSeam();
+            ASSERT_EQ(vertical, parallel.FindVerticalSeam()) << "seam " << i;
+            ASSERT_EQ(vertical, odd.FindVerticalSeam()) << "seam " << i;
+            single.RemoveVerticalSeam(vertical);
+            parallel.RemoveVerticalSeam(vertical);
+            odd.RemoveVerticalSeam(vertical);
+            const auto horizontal = single.FindHorizontalSeam();
+            ASSERT_EQ(horizontal, parallel.FindHorizontalSeam()) << "seam " << i;
+            ASSERT_EQ(horizontal, odd.FindHorizontalSeam()) << "seam " << i;
+            single.RemoveHorizontalSeam(horizontal);
+            parallel.RemoveHorizontalSeam(horizontal);
+            odd.RemoveHorizontalSeam(horizontal);
+        }
+        EXPECT_TRUE(SameImages(single.GetImage(), parallel.GetImage()));
+        EXPECT_TRUE(SameImages(single.GetImage(), odd.GetImage()));
+    }
+}
+
+TEST(ParallelSeamsTest, concurrent_searches)
+{
+    const SeamCarver carver(LargeImage(2), 2);
+    const auto vertical = carver.FindVerticalSeam();
+    const auto horizontal = carver.FindHorizontalSeam();
+    std::vector<std::thread> threads;
+    std::atomic<int> mismatches = 0;
+    for (size_t i = 0; i < 4; i++) {
+        threads.emplace_back([&, i] {
+            for (size_t j = 0; j < 5; j++) {
+                if ((i + j) % 2 == 0 ? carver.FindVerticalSeam() != vertical : carver.FindHorizontalSeam() != horizontal) {
+                    mismatches++;
+                }
+            }
+        });
+    }
+    for (auto & thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(0, mismatches);
+}
@@ -0,0 +1,83 @@
+#include "RemovalOrder.h"
+#include "SeamCarver.h"
+#include "TestImages.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+TEST(RemovalOrderTest, retarget_same_as_carving)
+{
+    const Image image = RandomImage(24, 16, 1);
+    const RemovalOrder order(image, 1);
+    ASSERT_TRUE(order.IsValid());
+    EXPECT_EQ(24, order.GetWidth());
+    EXPECT_EQ(16, order.GetHeight());
+    SeamCarver carver(image, 1);
+    EXPECT_TRUE(SameImages(image, order.Retarget(image, 24)));
+    EXPECT_TRUE(SameImages(image, order.Retarget(image, 100)));
+    for (size_t width = 23; width > 0; width--) {
+        carver.RemoveVerticalSeam(carver.FindVerticalSeam());
+        ASSERT_TRUE(SameImages(carver.GetImage(), order.Retarget(image, width))) << "width " << width;
+    }
+    const Image empty = order.Retarget(image, 0);
+    EXPECT_EQ(0, empty.GetWidth());
+    EXPECT_EQ(0, empty.GetHeight());
+}
+
+TEST(RemovalOrderTest, rows_are_permutations)
+{
+    const RemovalOrder order(RandomImage(10, 7, 2), 1);
+    for (size_t y = 0; y < order.GetHeight(); y++) {
+        std::vector<bool> seen(order.GetWidth());
+        for (size_t x = 0; x < order.GetWidth(); x++) {
+            const size_t index = order.GetRemovalIndex(x, y);
+            ASSERT_LT(index, order.GetWidth());
+            EXPECT_FALSE(seen[index]);
+            seen[index] = true;
+        }
+    }
+}
+
+TEST(RemovalOrderTest, write_and_read)
+{
+    const Image image = RandomImage(12, 9, 3);
+    const RemovalOrder order(image, 1);
+    std::stringstream strm;
+    order.Write(strm);
+    const RemovalOrder read(strm);
+    ASSERT_TRUE(read.IsValid());
+    EXPECT_EQ(order.GetWidth(), read.GetWidth());
+    EXPECT_EQ(order.GetHeight(), read.GetHeight());
+    for (size_t width = 0; width <= 12; width++) {
+        EXPECT_TRUE(SameImages(order.Retarget(image, width), read.Retarget(image, width)));
+    }
+}
+
+TEST(RemovalOrderTest, malformed_input)
+{
+    const auto valid = [](const std::string & text) {
+        std::istringstream input(text);
+        const RemovalOrder order(input);
+        if (!order.IsValid()) {
+            EXPECT_EQ(0, order.GetWidth());
+            EXPECT_EQ(0, order.GetHeight());
+        }
+        return order.IsValid();
+    };
+    EXPECT_TRUE(valid("2 2\n0 1\n1 0\n"));
+    EXPECT_TRUE(valid("0 0\n"));
+    EXPECT_FALSE(valid(""));
+    EXPECT_FALSE(valid("2 x\n"));
+    // truncated
+    EXPECT_FALSE(valid("2 2\n0 1\n1\n"));
+    // not a permutation
+    EXPECT_FALSE(valid("2 2\n0 1\n1 1\n"));
+    EXPECT_FALSE(valid("2 1\n0 2\n"));
+    // header promising more than the input holds doesn't allocate it
+    EXPECT_FALSE(valid("1000000000 1000000000\n0 1\n"));
+    EXPECT_FALSE(valid("18446744073709551615 2\n"));
+    EXPECT_FALSE(valid("4294967296 4294967296\n"));
+}
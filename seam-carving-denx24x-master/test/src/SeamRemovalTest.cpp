@@ -0,0 +1,110 @@
+#include "SeamCarver.h"
+#include "TestImages.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+
+using Seam = std::vector<size_t>;
+
+// connected seam of the length across positions [0:size-1]
+Seam RandomSeam(std::mt19937 & random, size_t length, size_t size)
+{
+    Seam seam(length);
+    seam[0] = random() % size;
+    for (size_t i = 1; i < length; i++) {
+        const size_t step = random() % 3;
+        seam[i] = std::min(size - 1, std::max<size_t>(seam[i - 1] + step, 1) - 1);
+    }
+    return seam;
+}
+
+Image RemoveVerticalNaively(const Image & image, const Seam & seam)
+{
+    auto table = ToTable(image);
+    std::vector<std::vector<Image::Pixel>> result(image.GetWidth() - 1);
+    for (size_t y = 0; y < image.GetHeight(); y++) {
+        for (size_t x = 0, column = 0; x < image.GetWidth(); x++) {
+            if (x != seam[y]) {
+                result[column++].push_back(table[x][y]);
+            }
+        }
+    }
+    return Image(result);
+}
+
+Image RemoveHorizontalNaively(const Image & image, const Seam & seam)
+{
+    auto table = ToTable(image);
+    for (size_t x = 0; x < image.GetWidth(); x++) {
+        table[x].erase(table[x].begin() + seam[x]);
+    }
+    return Image(table);
+}
+
+} // anonymous namespace
+
+TEST(SeamRemovalTest, vertical_seams_anywhere)
+{
+    std::mt19937 random(1);
+    Image expected = RandomImage(30, 20, 1);
+    SeamCarver carver(expected, 1);
+    while (expected.GetWidth() > 1) {
+        const Seam seam = RandomSeam(random, expected.GetHeight(), expected.GetWidth());
+        expected = RemoveVerticalNaively(expected, seam);
+        carver.RemoveVerticalSeam(seam);
+        ASSERT_TRUE(SameImages(expected, carver.GetImage())) << "width " << expected.GetWidth();
+    }
+}
+
+TEST(SeamRemovalTest, horizontal_seams_anywhere)
+{
+    std::mt19937 random(2);
+    Image expected = RandomImage(20, 30, 2);
+    SeamCarver carver(expected, 1);
+    while (expected.GetHeight() > 1) {
+        const Seam seam = RandomSeam(random, expected.GetWidth(), expected.GetHeight());
+        expected = RemoveHorizontalNaively(expected, seam);
+        carver.RemoveHorizontalSeam(seam);
+        ASSERT_TRUE(SameImages(expected, carver.GetImage())) << "height " << expected.GetHeight();
+    }
+}
+
+TEST(SeamRemovalTest, same_place_and_opposite_edges)
+{
+    Image expected = RandomImage(12, 8, 3);
+    SeamCarver carver(expected, 1);
+    // gaps stay in place, then jump from one edge to the other
+    for (const size_t position : {5, 5, 5, 0, 7, 0, 4}) {
+        const Seam seam(expected.GetHeight(), position);
+        expected = RemoveVerticalNaively(expected, seam);
+        carver.RemoveVerticalSeam(seam);
+        ASSERT_TRUE(SameImages(expected, carver.GetImage())) << "position " << position;
+    }
+}
+
+TEST(SeamRemovalTest, alternating_directions)
+{
+    std::mt19937 random(4);
+    Image expected = RandomImage(25, 25, 4);
+    SeamCarver carver(expected, 1);
+    for (size_t i = 0; i < 30; i++) {
+        if (random() % 2 == 0) {
+            const Seam seam = RandomSeam(random, expected.GetHeight(), expected.GetWidth());
+            expected = RemoveVerticalNaively(expected, seam);
+            carver.RemoveVerticalSeam(seam);
+        }
+        else {
+            const Seam seam = RandomSeam(random, expected.GetWidth(), expected.GetHeight());
+            expected = RemoveHorizontalNaively(expected, seam);
+            carver.RemoveHorizontalSeam(seam);
+        }
+        ASSERT_TRUE(SameImages(expected, carver.GetImage())) << "step " << i;
+        EXPECT_EQ(expected.GetWidth(), carver.GetImageWidth());
+        EXPECT_EQ(expected.GetHeight(), carver.GetImageHeight());
+    }
+}
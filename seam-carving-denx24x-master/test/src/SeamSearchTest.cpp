@@ -0,0 +1,84 @@
+#include "EnergyKernel.h"
+#include "SeamCarver.h"
+#include "TestImages.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using Seam = std::vector<size_t>;
+
+/**
+ * Vertical seam found with the whole table of costs and moves, the leftmost
+ * of equal predecessors and ends is taken
+ */
+Seam FindVerticalSeamNaively(const Image & image)
+{
+    const size_t width = image.GetWidth();
+    const size_t height = image.GetHeight();
+    std::vector<std::vector<double>> costs(height, std::vector<double>(width));
+    std::vector<std::vector<size_t>> previous(height, std::vector<size_t>(width));
+    for (size_t x = 0; x < width; x++) {
+        costs[0][x] = CalculatePixelEnergy(image, x, 0);
+    }
+    for (size_t y = 1; y < height; y++) {
+        for (size_t x = 0; x < width; x++) {
+            const size_t begin = x == 0 ? 0 : x - 1;
+            const size_t end = std::min(width, x + 2);
+            size_t best = begin;
+            for (size_t candidate = begin + 1; candidate < end; candidate++) {
+                if (costs[y - 1][candidate] < costs[y - 1][best]) {
+                    best = candidate;
+                }
+            }
+            previous[y][x] = best;
+            costs[y][x] = costs[y - 1][best] + CalculatePixelEnergy(image, x, y);
+        }
+    }
+    Seam seam(height);
+    seam[height - 1] = std::min_element(costs[height - 1].begin(), costs[height - 1].end()) - costs[height - 1].begin();
+    for (size_t y = height - 1; y > 0; y--) {
+        seam[y - 1] = previous[y][seam[y]];
+    }
+    return seam;
+}
+
+} // anonymous namespace
+
+TEST(SeamSearchTest, same_as_full_table)
+{
+    for (const int levels : {256, 2}) {
+        SeamCarver carver(RandomImage(33, 27, 1, levels), 1);
+        while (carver.GetImageWidth() > 1 && carver.GetImageHeight() > 1) {
+            const auto vertical = carver.FindVerticalSeam();
+            ASSERT_EQ(FindVerticalSeamNaively(carver.GetImage()), vertical);
+            carver.RemoveVerticalSeam(vertical);
+            const auto horizontal = carver.FindHorizontalSeam();
+            ASSERT_EQ(FindVerticalSeamNaively(Transpose(carver.GetImage())), horizontal);
+            carver.RemoveHorizontalSeam(horizontal);
+        }
+    }
+}
+
+TEST(SeamSearchTest, large_image)
+{
+    // rows of costs are reused many times over
+    const Image image = RandomImage(300, 260, 2);
+    const SeamCarver carver(image, 1);
+    EXPECT_EQ(FindVerticalSeamNaively(image), carver.FindVerticalSeam());
+    EXPECT_EQ(FindVerticalSeamNaively(Transpose(image)), carver.FindHorizontalSeam());
+}
+
+TEST(SeamSearchTest, thin_images)
+{
+    for (const auto & [width, height] : std::vector<std::pair<size_t, size_t>>{{1, 1}, {1, 5}, {5, 1}, {2, 2}, {2, 7}}) {
+        const Image image = RandomImage(width, height, static_cast<unsigned>(width * 10 + height));
+        const SeamCarver carver(image, 1);
+        EXPECT_EQ(FindVerticalSeamNaively(image), carver.FindVerticalSeam()) << width << "x" << height;
+        EXPECT_EQ(FindVerticalSeamNaively(Transpose(image)), carver.FindHorizontalSeam()) << width << "x" << height;
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include "Image.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+/**
+ * Image of the size with random channels in [0:levels-1],
+ * few levels make pixels of equal energy likely
+ */
+inline Image RandomImage(size_t width, size_t height, unsigned seed, int levels = 256)
+{
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<int> channel(0, levels - 1);
+    Image image(width, height);
+    for (size_t y = 0; y < image.GetHeight(); y++) {
+        for (size_t x = 0; x < image.GetWidth(); x++) {
+            image.SetPixel(x, y, Image::Pixel(channel(random), channel(random), channel(random)));
+        }
+    }
+    return image;
+}
+
+/**
+ * Table of columns, as taken by Image constructor
+ */
+inline std::vector<std::vector<Image::Pixel>> ToTable(const Image & image)
+{
+    std::vector<std::vector<Image::Pixel>> table(image.GetWidth());
+    for (size_t x = 0; x < image.GetWidth(); x++) {
+        for (size_t y = 0; y < image.GetHeight(); y++) {
+            table[x].push_back(image.GetPixel(x, y));
+        }
+    }
+    return table;
+}
+
+/**
+ * Image with rows and columns swapped
+ */
+inline Image Transpose(const Image & image)
+{
+    Image result(image.GetHeight(), image.GetWidth());
+    for (size_t y = 0; y < image.GetHeight(); y++) {
+        for (size_t x = 0; x < image.GetWidth(); x++) {
+            result.SetPixel(y, x, image.GetPixel(x, y));
+        }
+    }
+    return result;
+}
+
+inline ::testing::AssertionResult SameImages(const Image & expected, const Image & actual)
+{
+    if (expected.GetWidth() != actual.GetWidth() || expected.GetHeight() != actual.GetHeight()) {
+        return ::testing::AssertionFailure() << "size " << actual.GetWidth() << "x" << actual.GetHeight()
+                                             << " instead of " << expected.GetWidth() << "x" << expected.GetHeight();
+    }
+    for (size_t y = 0; y < expected.GetHeight(); y++) {
+        for (size_t x = 0; x < expected.GetWidth(); x++) {
+            const Image::Pixel left = expected.GetPixel(x, y);
+            const Image::Pixel right = actual.GetPixel(x, y);
+            if (left.m_red != right.m_red || left.m_green != right.m_green || left.m_blue != right.m_blue) {
+                return ::testing::AssertionFailure() << "pixel (" << x << ", " << y << ") differs";
+            }
+        }
+    }
+    return ::testing::AssertionSuccess();
+}
@@ -0,0 +1,49 @@
+#include "SeamCarver.h"
+#include "TestImages.h"
+
+#include <gtest/gtest.h>
+
+TEST(TransposedSeamsTest, horizontal_seams_of_transposed_image)
+{
+    for (const int levels : {256, 3}) {
+        const Image image = RandomImage(23, 31, 1, levels);
+        SeamCarver carver(image, 1);
+        SeamCarver transposed(Transpose(image), 1);
+        while (carver.GetImageHeight() > 1) {
+            const auto seam = carver.FindHorizontalSeam();
+            ASSERT_EQ(transposed.FindVerticalSeam(), seam);
+            carver.RemoveHorizontalSeam(seam);
+            transposed.RemoveVerticalSeam(seam);
+            ASSERT_TRUE(SameImages(Transpose(transposed.GetImage()), carver.GetImage()));
+        }
+    }
+}
+
+TEST(TransposedSeamsTest, energy_in_both_layouts)
+{
+    const Image image = RandomImage(17, 13, 2);
+    const SeamCarver carver(image, 1);
+    const SeamCarver transposed(Transpose(image), 1);
+    carver.FindHorizontalSeam();
+    for (size_t y = 0; y < image.GetHeight(); y++) {
+        for (size_t x = 0; x < image.GetWidth(); x++) {
+            EXPECT_EQ(transposed.GetPixelEnergy(y, x), carver.GetPixelEnergy(x, y));
+        }
+    }
+}
+
+TEST(TransposedSeamsTest, image_does_not_change_with_layout)
+{
+    SeamCarver carver(RandomImage(15, 12, 3), 1);
+    carver.RemoveVerticalSeam(carver.FindVerticalSeam());
+    const Image & image = carver.GetImage();
+    const Image copy = image;
+    // searches lay the buffers out for their direction
+    carver.FindHorizontalSeam();
+    carver.FindVerticalSeam();
+    carver.FindHorizontalSeams(3);
+    EXPECT_EQ(&image, &carver.GetImage());
+    EXPECT_TRUE(SameImages(copy, image));
+    EXPECT_EQ(14, carver.GetImageWidth());
+    EXPECT_EQ(12, carver.GetImageHeight());
+}
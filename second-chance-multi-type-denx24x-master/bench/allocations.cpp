@@ -0,0 +1,34 @@
+#include "allocations.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::size_t allocations_count = 0;
+
+} // anonymous namespace
+
+std::size_t AllocationsCount()
+{
+    return allocations_count;
+}
+
+void * operator new(std::size_t size)
+{
+    allocations_count++;
+    if (void * ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void * ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void * ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * Amount of global operator new calls so far, the operators are replaced
+ * in their own translation unit so that the compiler doesn't inline them
+ * into the code it measures
+ */
+std::size_t AllocationsCount();
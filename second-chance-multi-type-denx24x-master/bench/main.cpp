@@ -0,0 +1,193 @@
+#include "allocations.h"
+#include "allocator.h"
+#include "arc_policy.h"
+#include "cache.h"
+#include "clock_pro_policy.h"
+#include "s3fifo_policy.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+template <class Key>
+struct Entry
+{
+    Key key;
+    bool marked = false;
+
+    Entry(const Key & value)
+        : key(value)
+    {
+    }
+
+    template <class Other>
+    bool operator==(const Other & other) const
+    {
+        return key == other;
+    }
+
+    friend std::ostream & operator<<(std::ostream & strm, const Entry & entry)
+    {
+        return strm << entry.key;
+    }
+};
+
+struct Result
+{
+    std::string policy;
+    std::size_t capacity;
+    std::size_t gets;
+    std::size_t hits;
+    std::size_t allocations;
+    std::chrono::nanoseconds time;
+};
+
+template <class Key, template <class> class Policy, class Keys>
+Result Replay(const Keys & keys, const std::string & policy, const std::size_t capacity, const bool admission)
+{
+    using Value = Entry<Key>;
+    Cache<Key, Value, AllocatorWithPool, Policy> cache(capacity, capacity * sizeof(Value), std::initializer_list<std::size_t>{sizeof(Value)});
+    cache.set_admission_filter(admission);
+    Result result{admission ? policy + "+tinylfu" : policy, capacity, 0, 0, 0, {}};
+    const std::size_t allocations_before = AllocationsCount();
+    const auto start = std::chrono::steady_clock::now();
+    for (const auto & key : keys) {
+        Value & value = cache.template get<Value>(key);
+        result.hits += value.marked;
+        value.marked = true;
+        result.gets++;
+    }
+    result.time = std::chrono::steady_clock::now() - start;
+    result.allocations = AllocationsCount() - allocations_before;
+    return result;
+}
+
+void PrintResult(const Result & result)
+{
+    const auto gets = static_cast<double>(std::max<std::size_t>(result.gets, 1));
+    std::cout << result.policy
+              << "\t" << result.capacity
+              << "\t" << static_cast<double>(result.hits) / gets
+              << "\t" << static_cast<double>(result.time.count()) / gets
+              << "\t" << static_cast<double>(result.allocations) / gets << "\n";
+}
+
+std::vector<std::string> Split(const std::string & str, const char delimiter)
+{
+    std::vector<std::string> result;
+    std::size_t start = 0;
+    while (true) {
+        const std::size_t end = str.find(delimiter, start);
+        result.push_back(str.substr(start, end - start));
+        if (end == std::string::npos) {
+            return result;
+        }
+        start = end + 1;
+    }
+}
+
+const std::vector<std::string> policies = {"second-chance", "s3-fifo", "arc", "clock-pro"};
+
+template <class Key, class Keys>
+void Run(const Keys & keys, const std::vector<std::size_t> & capacities, const std::string & policy, const bool admission)
+{
+    std::cout << "policy\tcapacity\thit_ratio\tns_per_get\tallocations_per_get\n";
+    for (const auto & name : policies) {
+        if (policy != "all" && policy != name) {
+            continue;
+        }
+        for (const auto capacity : capacities) {
+            if (name == "second-chance") {
+                PrintResult(Replay<Key, SecondChancePolicy>(keys, name, capacity, admission));
+            }
+            else if (name == "s3-fifo") {
+                PrintResult(Replay<Key, S3FifoPolicy>(keys, name, capacity, admission));
+            }
+            else if (name == "arc") {
+                PrintResult(Replay<Key, ArcPolicy>(keys, name, capacity, admission));
+            }
+            else {
+                PrintResult(Replay<Key, ClockProPolicy>(keys, name, capacity, admission));
+            }
+        }
+    }
+}
+
+void PrintUsage()
+{
+    std::cout << "Usage: second-chance-bench [--policy=<policy>] [--admission] <trace> <capacity>...\n"
+              << "Policies: second-chance (default), s3-fifo, arc, clock-pro, all\n"
+              << "--admission puts TinyLFU admission filter in front of the policy\n"
+              << "Traces:\n"
+              << "  text:<path>                    one key per line\n"
+              << "  binary:<path>                  native-endian 64-bit keys\n"
+              << "  zipf:<keys>:<count>[:<alpha>]  zipf distributed keys (alpha defaults to 1)\n"
+              << "  scan:<count>                   keys that are never repeated\n"
+              << "  loop:<keys>:<count>            keys 0..keys-1 over and over\n";
+}
+
+} // anonymous namespace
+
+int main(int argc, char * argv[])
+{
+    const std::string policy_option = "--policy=";
+    std::string policy = "second-chance";
+    bool admission = false;
+    int first = 1;
+    if (argc > first && std::string(argv[first]).compare(0, policy_option.size(), policy_option) == 0) {
+        policy = std::string(argv[first]).substr(policy_option.size());
+        first++;
+    }
+    if (argc > first && std::string(argv[first]) == "--admission") {
+        admission = true;
+        first++;
+    }
+    if (argc < first + 2 || (policy != "all" && std::find(policies.begin(), policies.end(), policy) == policies.end())) {
+        PrintUsage();
+        return 1;
+    }
+    try {
+        std::vector<std::size_t> capacities;
+        for (int i = first + 1; i < argc; i++) {
+            capacities.push_back(std::stoull(argv[i]));
+            if (capacities.back() == 0) {
+                throw std::invalid_argument("capacity has to be positive");
+            }
+        }
+        const std::vector<std::string> trace = Split(argv[first], ':');
+        const std::string & kind = trace[0];
+        if ((kind == "text" || kind == "binary") && trace.size() == 2) {
+            MappedFile file(trace[1]);
+            if (kind == "text") {
+                Run<std::string>(TextTrace(file), capacities, policy, admission);
+            }
+            else {
+                Run<std::uint64_t>(BinaryTrace(file), capacities, policy, admission);
+            }
+        }
+        else if (kind == "zipf" && (trace.size() == 3 || trace.size() == 4)) {
+            const double alpha = trace.size() == 4 ? std::stod(trace[3]) : 1;
+            Run<std::uint64_t>(ZipfTrace(std::stoull(trace[1]), std::stoull(trace[2]), alpha), capacities, policy, admission);
+        }
+        else if (kind == "scan" && trace.size() == 2) {
+            Run<std::uint64_t>(ScanTrace(std::stoull(trace[1])), capacities, policy, admission);
+        }
+        else if (kind == "loop" && trace.size() == 3) {
+            Run<std::uint64_t>(LoopTrace(std::stoull(trace[1]), std::stoull(trace[2])), capacities, policy, admission);
+        }
+        else {
+            PrintUsage();
+            return 1;
+        }
+    }
+    catch (const std::exception & e) {
+        std::cout << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
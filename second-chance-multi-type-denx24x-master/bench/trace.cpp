@@ -0,0 +1,121 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string & path)
+{
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("can't open " + path);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        throw std::runtime_error("can't stat " + path);
+    }
+    m_size = info.st_size;
+    if (m_size != 0) {
+        m_data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (m_data == MAP_FAILED) {
+        throw std::runtime_error("can't map " + path);
+    }
+    if (m_data != nullptr) {
+        madvise(m_data, m_size, MADV_SEQUENTIAL);
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data != nullptr) {
+        munmap(m_data, m_size);
+    }
+}
+
+const std::byte * MappedFile::data() const
+{
+    return static_cast<const std::byte *>(m_data);
+}
+
+std::size_t MappedFile::size() const
+{
+    return m_size;
+}
+
+std::vector<std::string_view> TextTrace(const MappedFile & file)
+{
+    std::vector<std::string_view> result;
+    const std::string_view text(reinterpret_cast<const char *>(file.data()), file.size());
+    std::size_t start = 0;
+    while (start < text.size()) {
+        std::size_t end = text.find('\n', start);
+        if (end == std::string_view::npos) {
+            end = text.size();
+        }
+        if (end != start) {
+            result.push_back(text.substr(start, end - start));
+        }
+        start = end + 1;
+    }
+    return result;
+}
+
+KeySpan<std::uint64_t> BinaryTrace(const MappedFile & file)
+{
+    if (file.size() % sizeof(std::uint64_t) != 0) {
+        throw std::runtime_error("binary trace size has to be a multiple of 8");
+    }
+    return {reinterpret_cast<const std::uint64_t *>(file.data()), file.size() / sizeof(std::uint64_t)};
+}
+
+std::vector<std::uint64_t> ZipfTrace(const std::size_t keys, const std::size_t count, const double alpha, const std::uint64_t seed)
+{
+    if (keys == 0) {
+        throw std::invalid_argument("amount of keys has to be positive");
+    }
+    std::vector<double> cdf(keys);
+    double sum = 0;
+    for (std::size_t i = 0; i < keys; i++) {
+        sum += 1 / std::pow(static_cast<double>(i + 1), alpha);
+        cdf[i] = sum;
+    }
+    std::mt19937_64 random(seed);
+    std::uniform_real_distribution<double> uniform(0, sum);
+    std::vector<std::uint64_t> result;
+    result.reserve(count);
+    for (std::size_t i = 0; i < count; i++) {
+        const std::size_t rank = std::lower_bound(cdf.begin(), cdf.end(), uniform(random)) - cdf.begin();
+        result.push_back(std::min(rank, keys - 1));
+    }
+    return result;
+}
+
+std::vector<std::uint64_t> ScanTrace(const std::size_t count)
+{
+    std::vector<std::uint64_t> result(count);
+    for (std::size_t i = 0; i < count; i++) {
+        result[i] = i;
+    }
+    return result;
+}
+
+std::vector<std::uint64_t> LoopTrace(const std::size_t keys, const std::size_t count)
+{
+    if (keys == 0) {
+        throw std::invalid_argument("amount of keys has to be positive");
+    }
+    std::vector<std::uint64_t> result(count);
+    for (std::size_t i = 0; i < count; i++) {
+        result[i] = i % keys;
+    }
+    return result;
+}
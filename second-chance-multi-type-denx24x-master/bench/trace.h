@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Read-only memory mapping of a whole file
+ */
+class MappedFile
+{
+public:
+    MappedFile(const std::string & path);
+    MappedFile(const MappedFile &) = delete;
+    MappedFile & operator=(const MappedFile &) = delete;
+    ~MappedFile();
+
+    const std::byte * data() const;
+    std::size_t size() const;
+
+private:
+    void * m_data = nullptr;
+    std::size_t m_size = 0;
+};
+
+/**
+ * Contiguous sequence of keys, that isn't owned
+ */
+template <class T>
+struct KeySpan
+{
+    const T * begin() const { return data; }
+    const T * end() const { return data + size; }
+
+    const T * data = nullptr;
+    std::size_t size = 0;
+};
+
+/**
+ * Splits mapped text file to keys, one per line (empty lines are skipped)
+ */
+std::vector<std::string_view> TextTrace(const MappedFile & file);
+
+/**
+ * Views mapped file as native-endian 64-bit keys
+ */
+KeySpan<std::uint64_t> BinaryTrace(const MappedFile & file);
+
+/**
+ * Generators of synthetic traces
+ */
+std::vector<std::uint64_t> ZipfTrace(const std::size_t keys, const std::size_t count, const double alpha, const std::uint64_t seed = 1);
+std::vector<std::uint64_t> ScanTrace(const std::size_t count);
+std::vector<std::uint64_t> LoopTrace(const std::size_t keys, const std::size_t count);
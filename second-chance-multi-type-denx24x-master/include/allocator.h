@@ -1,22 +1,115 @@
 #pragma once
 
+#include "magazine_pool.h"
 #include "pool.h"
+#include "pool_resource.h"
 
 #include <cstdint>
+#include <memory_resource>
+#include <new>
 
 class AllocatorWithPool : private PoolAllocator
 {
 public:
-    AllocatorWithPool(const std::size_t size, std::initializer_list<std::size_t> sizes)
-        : PoolAllocator(size, sizes)
+    AllocatorWithPool(const std::size_t size, std::initializer_list<std::size_t> sizes, const PoolStorage & storage = {})
+        : AllocatorWithPool(size, sizes, {}, storage)
     {
     }
 
+    /**
+     * Memory owned by the elements comes from a pool of its own with
+     * buffer_sizes classes, so buffers never take slots of the elements
+     */
+    AllocatorWithPool(const std::size_t size, std::initializer_list<std::size_t> sizes, std::initializer_list<std::size_t> buffer_sizes, const PoolStorage & storage = {})
+        : PoolAllocator(size, sizes, storage)
+        , m_buffers(size, buffer_sizes, storage)
+        , m_resource(m_buffers)
+    {
+    }
+
+    /**
+     * Memory resource of the buffers pool for memory owned by the elements,
+     * requests it can't serve go to the default resource
+     */
+    std::pmr::memory_resource * resource()
+    {
+        return &m_resource;
+    }
+
     template <class T, class... Args>
     T * create(Args &&... args)
     {
-        auto * ptr = allocate(sizeof(T));
-        return new (ptr) T(std::forward<Args>(args)...);
+        if (T * ptr = try_create<T>(std::forward<Args>(args)...)) {
+            return ptr;
+        }
+        throw std::bad_alloc{};
+    }
+
+    /**
+     * Returns nullptr if the size class of T is full, args are left untouched then
+     */
+    template <class T, class... Args>
+    T * try_create(Args &&... args)
+    {
+        void * ptr = try_allocate(sizeof(T));
+        if (ptr == nullptr) {
+            return nullptr;
+        }
+        try {
+            return new (ptr) T(std::forward<Args>(args)...);
+        }
+        catch (...) {
+            deallocate(ptr);
+            throw;
+        }
+    }
+
+    template <class T>
+    void destroy(void * ptr)
+    {
+        static_cast<T *>(ptr)->~T();
+        deallocate(ptr);
+    }
+
+private:
+    PoolAllocator m_buffers;
+    PoolMemoryResource m_resource;
+};
+
+class AllocatorWithMagazines : private MagazinePoolAllocator
+{
+public:
+    AllocatorWithMagazines(const std::size_t size, std::initializer_list<std::size_t> sizes, const std::size_t magazine_size = default_magazine_size)
+        : MagazinePoolAllocator(size, sizes, magazine_size)
+    {
+    }
+
+    template <class T, class... Args>
+    T * create(Args &&... args)
+    {
+        if (T * ptr = try_create<T>(std::forward<Args>(args)...)) {
+            return ptr;
+        }
+        throw std::bad_alloc{};
+    }
+
+    /**
+     * Returns nullptr if the size class of T is full, args are left untouched then
+     */
+    template <class T, class... Args>
+    T * try_create(Args &&... args)
+    {
+        void * ptr = try_allocate(sizeof(T));
+        if (ptr == nullptr) {
+            return nullptr;
+        }
+        try {
+            return new (ptr) T(std::forward<Args>(args)...);
+        }
+        catch (...) {
+            deallocate(ptr);
+            throw;
+        }
     }
 
     template <class T>
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "ghost_list.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <list>
+#include <optional>
+
+/**
+ * ARC (Megiddo, Modha, FAST'03): resident entries are split between
+ * recently (T1) and frequently (T2) used LRU lists, evicted ones are
+ * remembered in ghost lists B1 and B2. Misses on ghosts move the target
+ * size of T1 towards the list that would have kept the entry.
+ * Interface is described in second_chance_policy.h.
+ */
+template <class Entry>
+class ArcPolicy
+{
+    struct Node
+    {
+        Entry entry;
+        std::size_t hash;
+        bool frequent = false;
+    };
+
+public:
+    using Handle = typename std::list<Node>::iterator;
+
+    static constexpr bool uses_history = true;
+
+    ArcPolicy(const std::size_t capacity)
+        : m_capacity(capacity)
+    {
+    }
+
+    std::size_t size() const
+    {
+        return m_recent.size() + m_frequent.size();
+    }
+
+    template <class Pred>
+    std::optional<Handle> find(Pred && pred)
+    {
+        for (auto * list : {&m_recent, &m_frequent}) {
+            for (auto it = list->begin(); it != list->end(); ++it) {
+                if (pred(it->entry)) {
+                    return it;
+                }
+            }
+        }
+        return std::nullopt;
+    }
+
+    Entry & hit(const Handle handle)
+    {
+        m_frequent.splice(m_frequent.begin(), handle->frequent ? m_frequent : m_recent, handle);
+        handle->frequent = true;
+        return handle->entry;
+    }
+
+    void miss(const std::size_t hash)
+    {
+        if (m_recent_ghosts.contains(hash)) {
+            const std::size_t delta = std::max<std::size_t>(1, m_frequent_ghosts.size() / m_recent_ghosts.size());
+            m_target = std::min(m_capacity, m_target + delta);
+        }
+        else if (m_frequent_ghosts.contains(hash)) {
+            const std::size_t delta = std::max<std::size_t>(1, m_recent_ghosts.size() / m_frequent_ghosts.size());
+            m_target -= std::min(m_target, delta);
+        }
+    }
+
+    template <class Requeue>
+    Entry & victim(const std::size_t hash, Requeue &&)
+    {
+        const bool from_recent = !m_recent.empty() &&
+                (m_frequent.empty() || m_recent.size() > m_target || (m_recent.size() == m_target && m_frequent_ghosts.contains(hash)));
+        m_victim = std::prev(from_recent ? m_recent.end() : m_frequent.end());
+        return m_victim->entry;
+    }
+
+    void remove_victim()
+    {
+        (m_victim->frequent ? m_frequent_ghosts : m_recent_ghosts).push(m_victim->hash);
+        (m_victim->frequent ? m_frequent : m_recent).erase(m_victim);
+    }
+
+    Handle insert(const Entry & entry, const std::size_t hash)
+    {
+        Handle result;
+        if (m_recent_ghosts.contains(hash) || m_frequent_ghosts.contains(hash)) {
+            m_recent_ghosts.erase(hash);
+            m_frequent_ghosts.erase(hash);
+            m_frequent.push_front(Node{entry, hash, true});
+            result = m_frequent.begin();
+        }
+        else {
+            m_recent.push_front(Node{entry, hash});
+            result = m_recent.begin();
+        }
+        // keep directory within ARC bounds: |T1| + |B1| <= c, |T1| + |T2| + |B1| + |B2| <= 2c
+        while (!m_recent_ghosts.empty() && m_recent.size() + m_recent_ghosts.size() > m_capacity) {
+            m_recent_ghosts.pop_oldest();
+        }
+        while (!m_frequent_ghosts.empty() && size() + m_recent_ghosts.size() + m_frequent_ghosts.size() > 2 * m_capacity) {
+            m_frequent_ghosts.pop_oldest();
+        }
+        return result;
+    }
+
+    Entry erase(const Handle handle)
+    {
+        Entry result = handle->entry;
+        (handle->frequent ? m_frequent : m_recent).erase(handle);
+        return result;
+    }
+
+    template <class Func>
+    void for_each(Func && func) const
+    {
+        for (const auto * list : {&m_recent, &m_frequent}) {
+            for (const auto & node : *list) {
+                func(node.entry, node.frequent);
+            }
+        }
+    }
+
+private:
+    const std::size_t m_capacity;
+    // target size of T1
+    std::size_t m_target = 0;
+    std::list<Node> m_recent;
+    std::list<Node> m_frequent;
+    GhostList m_recent_ghosts;
+    GhostList m_frequent_ghosts;
+    Handle m_victim;
+};
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "cache.h"
+#include "thread_pool.h"
+
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Thread-safe cache, that builds missed elements on a pool of workers.
+ *
+ * While an element is being built its key is pending: other misses on
+ * the same key don't start another construction, but wait for the running
+ * one ("single flight"). The element is built without holding the cache
+ * lock and then moved into the cache, so elements have to be movable.
+ */
+template <class Key, class KeyProvider, class Allocator, template <class> class Policy = SecondChancePolicy, class Hash = KeyHash<Key>>
+class AsyncCache
+{
+    using Storage = Cache<Key, KeyProvider, Allocator, Policy, Hash>;
+    // called with the element (or exception, that occurred while building it)
+    using Waiter = std::function<void(KeyProvider *, std::exception_ptr)>;
+
+public:
+    template <class... AllocArgs>
+    AsyncCache(const std::size_t cache_size, const std::size_t workers_count, AllocArgs &&... alloc_args)
+        : m_cache(cache_size, std::forward<AllocArgs>(alloc_args)...)
+        , m_workers(workers_count)
+    {
+    }
+
+    std::size_t size() const
+    {
+        std::lock_guard lock(m_mutex);
+        return m_cache.size();
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    /**
+     * Returns future result of func(T &) called with the element for the key.
+     * On a hit func is called right away, otherwise once the element is built.
+     * Func is called with the cache locked, so it must not use this cache.
+     */
+    template <class T, class K, class Func>
+    std::future<std::invoke_result_t<Func, T &>> get(const K & key, Func && func);
+
+    CacheStatsSnapshot stats() const
+    {
+        std::lock_guard lock(m_mutex);
+        return m_cache.stats();
+    }
+
+    std::ostream & print(std::ostream & strm) const
+    {
+        std::lock_guard lock(m_mutex);
+        return m_cache.print(strm);
+    }
+
+    friend std::ostream & operator<<(std::ostream & strm, const AsyncCache & cache)
+    {
+        return cache.print(strm);
+    }
+
+private:
+    template <class T>
+    void build(const Key & key);
+
+    mutable std::mutex m_mutex;
+    Storage m_cache;
+    std::unordered_map<Key, std::vector<Waiter>, Hash> m_pending;
+    // workers go first on destruction, while the cache is still alive
+    ThreadPool m_workers;
+};
+
+template <class Key, class KeyProvider, class Allocator, template <class> class Policy, class Hash>
+template <class T, class K, class Func>
+inline std::future<std::invoke_result_t<Func, T &>> AsyncCache<Key, KeyProvider, Allocator, Policy, Hash>::get(const K & key, Func && func)
+{
+    static_assert(std::is_move_constructible_v<T>, "Elements are moved into the cache after being built");
+    using Result = std::invoke_result_t<Func, T &>;
+    auto task = std::make_shared<std::packaged_task<Result(KeyProvider *, std::exception_ptr)>>(
+            [func = std::forward<Func>(func)](KeyProvider * element, std::exception_ptr error) mutable -> Result {
+                if (error) {
+                    std::rethrow_exception(error);
+                }
+                return func(*static_cast<T *>(element));
+            });
+    auto result = task->get_future();
+
+    std::lock_guard lock(m_mutex);
+    if (T * found = m_cache.template find<T>(key)) {
+        (*task)(found, nullptr);
+        return result;
+    }
+    Key pending_key(key);
+    auto [it, added] = m_pending.try_emplace(pending_key);
+    it->second.push_back([task](KeyProvider * element, std::exception_ptr error) {
+        (*task)(element, std::move(error));
+    });
+    if (added) {
+        m_workers.submit([this, pending_key = std::move(pending_key)] {
+            build<T>(pending_key);
+        });
+    }
+    return result;
+}
+
+template <class Key, class KeyProvider, class Allocator, template <class> class Policy, class Hash>
+template <class T>
+inline void AsyncCache<Key, KeyProvider, Allocator, Policy, Hash>::build(const Key & key)
+{
+    std::optional<T> value;
+    std::exception_ptr error;
+    try {
+        value.emplace(key);
+    }
+    catch (...) {
+        error = std::current_exception();
+    }
+
+    std::lock_guard lock(m_mutex);
+    auto waiters = m_pending.extract(key);
+    KeyProvider * element = nullptr;
+    if (!error) {
+        try {
+            element = &m_cache.template emplace<T>(key, std::move(*value));
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+    }
+    for (auto & waiter : waiters.mapped()) {
+        waiter(element, error);
+    }
+}
@@ -1,22 +1,64 @@
 #pragma once
 
+#include "cache_stats.h"
+#include "frequency_sketch.h"
+#include "key_hash.h"
+#include "memory_usage.h"
+#include "second_chance_policy.h"
+#include "snapshot.h"
+#include "spill_file.h"
+#include "thread_pool.h"
+#include "timer_wheel.h"
+
 #include <algorithm>
+#include <chrono>
 #include <cstddef>
-#include <list>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <memory>
 #include <new>
+#include <optional>
 #include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
 #include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
-template <class Key, class KeyProvider, class Allocator>
+/**
+ * Cache of elements derived from KeyProvider, evicted by Policy.
+ * Keys, that Hash accepts, are looked up in a hash index, so
+ * KeyProvider::operator== has to agree with Hash: an element equal
+ * to a key has to have the key's hash (e.g. a case insensitive
+ * operator== needs a case insensitive Hash). Without a usable Hash
+ * elements are found by comparing them with the key one by one.
+ */
+template <class Key, class KeyProvider, class Allocator, template <class> class Policy = SecondChancePolicy, class Hash = KeyHash<Key>>
 class Cache
 {
     static_assert(std::is_constructible_v<KeyProvider, const Key &>, "KeyProvider has to be constructible from Key");
     struct CacheElement
     {
         KeyProvider * element;
-        bool flag = false;
-        CacheElement(KeyProvider * val)
+        std::size_t hash;
+        CacheStatsCollector::Tag tag;
+        // bytes counted against memory limit
+        std::size_t usage;
+        const SnapshotType<KeyProvider> * type;
+        // number of the last access, orders dumped elements
+        std::uint64_t last_use;
+        CacheElement(KeyProvider * val, const std::size_t key_hash, const CacheStatsCollector::Tag stats_tag, const std::size_t bytes, const SnapshotType<KeyProvider> * snapshot, const std::uint64_t use)
             : element(val)
+            , hash(key_hash)
+            , tag(stats_tag)
+            , usage(bytes)
+            , type(snapshot)
+            , last_use(use)
         {
         }
 
@@ -27,26 +69,203 @@ class Cache
         }
     };
 
+    using EvictionPolicy = Policy<CacheElement>;
+    using Handle = typename EvictionPolicy::Handle;
+
+    // keys without a usable hash are looked up by scanning the policy
+    static constexpr bool indexed = is_lookup_key_v<Key, KeyProvider, Hash>;
+    static_assert(indexed || !EvictionPolicy::uses_history, "Eviction policy requires hashable keys");
+
+    // evicted elements can be written to the spill file
+    static constexpr bool spillable = indexed && has_serializer_v<Key> && has_key_v<KeyProvider, Key>;
+
+    // timers tick every millisecond since the cache was created
+    struct Expiry
+    {
+        KeyProvider * element;
+        std::size_t hash;
+    };
+
+    using Timers = TimerWheel<Expiry>;
+    using Timer = typename Timers::Handle;
+
+    struct IndexEntry
+    {
+        KeyProvider * element;
+        Handle handle;
+        std::optional<Timer> timer;
+    };
+
+    using IndexIterator = typename std::unordered_multimap<std::size_t, IndexEntry>::iterator;
+
 public:
     template <class... AllocArgs>
     Cache(const std::size_t cache_size, AllocArgs &&... alloc_args)
         : m_max_size(cache_size)
+        , m_policy(cache_size)
         , m_alloc(std::forward<AllocArgs>(alloc_args)...)
     {
+        if constexpr (indexed) {
+            m_index.reserve(cache_size);
+        }
     }
 
+    Cache(const Cache &) = delete;
+    Cache & operator=(const Cache &) = delete;
+    ~Cache();
+
     std::size_t size() const
     {
-        return m_queue.size();
+        return m_policy.size();
     }
 
     bool empty() const
     {
-        return m_queue.empty();
+        return m_policy.size() == 0;
+    }
+
+    std::size_t capacity() const
+    {
+        return m_max_size;
+    }
+
+    /**
+     * Bytes taken by cached elements, see element_memory_usage()
+     */
+    std::size_t memory_usage() const
+    {
+        return m_memory_usage;
+    }
+
+    std::size_t memory_limit() const
+    {
+        return m_memory_limit;
+    }
+
+    /**
+     * Bounds memory taken by cached elements in addition to their count,
+     * 0 removes the bound. Elements are evicted until a new one fits,
+     * one that doesn't fit in an empty cache is still cached alone.
+     */
+    void set_memory_limit(const std::size_t bytes)
+    {
+        m_memory_limit = bytes;
+    }
+
+    /**
+     * Enables TinyLFU admission: once the cache is full, a missed key
+     * is cached only if it was requested more often than the victim it
+     * would replace. Otherwise the element is transient, it isn't cached
+     * and lives until the next rejected miss.
+     */
+    void set_admission_filter(const bool enabled)
+    {
+        static_assert(indexed, "Admission filter requires hashable keys");
+        if (!enabled) {
+            m_sketch.reset();
+        }
+        else if (!m_sketch) {
+            m_sketch.emplace(m_max_size);
+        }
+    }
+
+    /**
+     * Sets time to live of elements cached from now on, 0 keeps them
+     * until they are evicted
+     */
+    void set_default_ttl(const std::chrono::milliseconds ttl)
+    {
+        static_assert(indexed, "Time to live requires hashable keys");
+        m_default_ttl = ttl;
+    }
+
+    /**
+     * Sets time to live of the cached element for the key counting from now,
+     * 0 keeps it until it's evicted. Returns false if the key isn't cached.
+     * Expired element is removed once it's looked up or once there is
+     * no room for a new one, before anything is evicted.
+     */
+    template <class K = Key>
+    bool expire_after(const K & key, std::chrono::milliseconds ttl);
+
+    /**
+     * Adds the second tier: evicted elements of types with a Serializer
+     * are written to a memory mapped file of the capacity (in bytes),
+     * a miss reads the element back from it before building a new one.
+     * Requires Key to have a Serializer and KeyProvider to return its
+     * key with key().
+     */
+    void set_spill_file(const std::string & path, const std::size_t capacity)
+    {
+        static_assert(spillable, "Spill file requires serializable keys");
+        m_spill = std::make_unique<SpillFile>(path, capacity);
     }
 
+    /**
+     * Returns element of type T for the key, creating it on a miss.
+     * Key can be of any type the hash and KeyProvider::operator== accept
+     * (e.g. std::string_view for std::string keys), then Key is built only
+     * to create a new element. Other types are converted to Key first.
+     */
+    template <class T, class K = Key>
+    T & get(const K & key);
+
+    /**
+     * Returns element of type T for the key or nullptr if it's not cached,
+     * found element is marked as used like with get()
+     */
+    template <class T, class K = Key>
+    T * find(const K & key);
+
+    /**
+     * Returns element of type T for the key, creating it from args on a miss
+     */
+    template <class T, class K = Key, class... Args>
+    T & emplace(const K & key, Args &&... args);
+
+    /**
+     * Writes cached keys to the file from the most recently used one
+     * with their reference flags. Elements of types with
+     * a Serializer are written as well. Requires Key to have a Serializer
+     * and KeyProvider to return its key with key().
+     */
+    void dump(const std::string & path) const;
+
+    /**
+     * Caches elements of type T recorded in a dump. Stored elements are
+     * read back, others are built by loader(key) called concurrently
+     * from workers_count threads.
+     * Elements are inserted oldest first bypassing admission filter,
+     * so the cache ends up ordered as when it was dumped.
+     * Returns amount of elements, that were restored.
+     */
+    template <class T, class Loader>
+    std::size_t warm(const std::string & path, Loader && loader, const std::size_t workers_count = std::thread::hardware_concurrency());
+
     template <class T>
-    T & get(const Key & key);
+    std::size_t warm(const std::string & path)
+    {
+        return warm<T>(path, [](const Key & key) {
+            return T(key);
+        });
+    }
+
+    /**
+     * Allocator of cached elements, e.g. to give them memory resource
+     * of the same pool
+     */
+    Allocator & allocator()
+    {
+        return m_alloc;
+    }
+
+    /**
+     * Returns copy of the counters, empty unless built with CACHE_STATS
+     */
+    CacheStatsSnapshot stats() const
+    {
+        return m_stats.snapshot();
+    }
 
     std::ostream & print(std::ostream & strm) const;
 
@@ -56,54 +275,624 @@ public:
     }
 
 private:
+    template <class K>
+    static std::size_t hash(const K & key)
+    {
+        if constexpr (indexed) {
+            return Hash{}(key);
+        }
+        else {
+            static_cast<void>(key);
+            return 0;
+        }
+    }
+
+    // K is used for lookup as is, otherwise it's converted to Key
+    template <class K>
+    static constexpr bool direct_lookup = std::is_same_v<K, Key> || (indexed && is_lookup_key_v<K, KeyProvider, Hash>);
+
+    template <class K>
+    std::optional<Handle> lookup(const K & key, const std::size_t key_hash);
+
+    template <class K>
+    IndexIterator find_entry(const K & key, const std::size_t key_hash);
+
+    IndexIterator find_element(const std::size_t key_hash, const KeyProvider * element);
+
+    std::uint64_t now_tick() const
+    {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_epoch).count());
+    }
+
+    bool expired(const IndexEntry & entry) const
+    {
+        return entry.timer && m_timers->deadline(*entry.timer) <= now_tick();
+    }
+
+    Timer schedule(KeyProvider * element, const std::size_t key_hash, const std::chrono::milliseconds ttl);
+
+    // removes element, whose timer is already cancelled or due
+    void remove_expired(IndexIterator entry);
+
+    // removes the oldest due element, returns false if there is none
+    bool expire_due();
+
+    // filtered elements have to pass admission filter, if it's enabled
+    template <class T, class K, class... Args>
+    T & insert(const K & key, const std::size_t key_hash, const bool filtered, Args &&... args);
+
+    template <class T, class K, class... Args>
+    T & make_transient(const K & key, Args &&... args);
+
+    // builds T from args or from the key, nullptr if the allocator has no room for it
+    template <class T, class K, class... Args>
+    T * try_create(const K & key, Args &&... args);
+
+    CacheElement & use(const Handle handle)
+    {
+        CacheElement & val = m_policy.hit(handle);
+        val.last_use = ++m_use_count;
+        return val;
+    }
+
+    bool needs_room(const std::size_t usage) const
+    {
+        return m_policy.size() >= m_max_size ||
+                (m_memory_limit != 0 && m_policy.size() != 0 && m_memory_usage + usage > m_memory_limit);
+    }
+
+    void record_access(const std::size_t key_hash)
+    {
+        if (m_sketch) {
+            m_sketch->increment(key_hash);
+        }
+    }
+
+    void unindex(const CacheElement & val);
+
+    template <class K>
+    static std::string key_bytes(const K & key);
+
+    void spill(const CacheElement & val);
+
+    // moves element from the spill file back to the cache
+    template <class T, class K>
+    T * restore(const K & key, const std::size_t key_hash);
+
+    static constexpr char snapshot_magic[] = {'S', 'C', 'C', 'A', 'C', 'H', 'E', '1'};
+
     const std::size_t m_max_size;
-    std::list<CacheElement> m_queue;
-    AllocatorWithPool m_alloc;
+    std::size_t m_memory_limit = 0;
+    std::size_t m_memory_usage = 0;
+    std::uint64_t m_use_count = 0;
+    EvictionPolicy m_policy;
+    std::unordered_multimap<std::size_t, IndexEntry> m_index;
+    Allocator m_alloc;
+    CacheStatsCollector m_stats;
+    std::optional<FrequencySketch> m_sketch;
+    // element, that was rejected by admission filter
+    std::unique_ptr<KeyProvider, void (*)(KeyProvider *)> m_transient{nullptr, nullptr};
+    std::unique_ptr<SpillFile> m_spill;
+    std::chrono::milliseconds m_default_ttl{0};
+    const std::chrono::steady_clock::time_point m_epoch = std::chrono::steady_clock::now();
+    // created once the first time to live is set
+    std::unique_ptr<Timers> m_timers;
 };
 
-template <class Key, class KeyProvider, class Allocator>
-template <class T>
-inline T & Cache<Key, KeyProvider, Allocator>::get(const Key & key)
+template <class Key, class KeyProvider, class Allocator, template <class> class Policy, class Hash>
+inline Cache<Key, KeyProvider, Allocator, Policy, Hash>::~Cache()
 {
-    static_assert(std::is_base_of_v<KeyProvider, T>, "Key has to be the base class of KeyProvider");
-    auto it = std::find_if(m_queue.begin(), m_queue.end(), [&key](const CacheElement ptr) {
-        return *ptr.element == key;
+    m_policy.for_each([this](const CacheElement & val, const bool) {
+        m_alloc.template destroy<KeyProvider>(val.element);
     });
-    if (it != m_queue.end()) {
-        it->flag = true;
-        return it->template get<T>();
+}
+
+template <class Key, class KeyProvider, class Allocator, template <class> class Policy, class Hash>
+template <class T, class K>
+inline T & Cache<Key, KeyProvider, Allocator, Policy, Hash>::get(const K & key)
+{
+    return emplace<T>(key);
+}
+
+template <class Key, class KeyProvider, class Allocator, template <class> class Policy, class Hash>
+template <class T, class K>
+inline T * Cache<Key, KeyProvider, Allocator, Policy, Hash>::find(const K & key)
+{
+    static_assert(std::is_base_of_v<KeyProvider, T>, "Key has to be the base class of KeyProvider");
+    if constexpr (!direct_lookup<K>) {
+        return find<T, Key>(Key(key));
+    }
+    else {
+        const std::size_t key_hash = hash(key);
+        const auto found = lookup(key, key_hash);
+        if (!found) {
+            return restore<T>(key, key_hash);
+        }
+        record_access(key_hash);
+        m_stats.hit(CacheStatsCollector::tag<T>());
+        return &use(*found).template get<T>();
     }
+}
 
-    while (m_queue.size() == m_max_size) {
-        CacheElement val = m_queue.back();
-        if (val.flag) {
-            val.flag = false;
-            m_queue.push_front(val);
+template <class Key, class KeyProvider, class Allocator, template <class> class Policy, class Hash>
+template <class T, class K, class... Args>
+inline T & Cache<Key, KeyProvider, Allocator, Policy, Hash>::emplace(const K & key, Args &&... args)
+{
+    static_assert(std::is_base_of_v<KeyProvider, T>, "Key has to be the base class of KeyProvider");
+    if constexpr (!direct_lookup<K>) {
+        return emplace<T, Key>(Key(key), std::forward<Args>(args)...);
+    }
+    else {
+        const std::size_t key_hash = hash(key);
+        const auto found = lookup(key, key_hash);
+        record_access(key_hash);
+        if (found) {
+            m_stats.hit(CacheStatsCollector::tag<T>());
+            return use(*found).template get<T>();
         }
-        else {
-            m_alloc.destroy<KeyProvider>(val.element);
+        if (T * restored = restore<T>(key, key_hash)) {
+            return *restored;
+        }
+        return insert<T>(key, key_hash, true, std::forward<Args>(args)...);
+    }
+}
+
+template <class Key, class KeyProvider, class Allocator, template <class> class Policy, class Hash>
+template <class T, class K, class... Args>
+inline T & Cache<Key, KeyProvider, Allocator, Policy, Hash>::insert(const K & key, const std::size_t key_hash, const bool filtered, Args &&... args)
+{
+    const auto tag = CacheStatsCollector::tag<T>();
+    m_stats.miss(tag);
+    m_policy.miss(key_hash);
+    std::size_t sweep_length = 0;
+    bool admitted = !filtered || !m_sketch;
+    const auto requeue = [this, &sweep_length](const CacheElement & val) {
+        sweep_length++;
+        m_stats.requeue(val.tag);
+    };
+    const auto evict = [this](CacheElement & val) {
+        m_stats.eviction(val.tag);
+        m_memory_usage -= val.usage;
+        unindex(val);
+        spill(val);
+        m_alloc.template destroy<KeyProvider>(val.element);
+        m_policy.remove_victim();
+    };
+    // the first victim decides whether the new element is admitted
+    const auto admits = [this, &admitted, &sweep_length, tag, key_hash](const CacheElement & val) {
+        sweep_length++;
+        if (!admitted) {
+            if (m_sketch->frequency(key_hash) <= m_sketch->frequency(val.hash)) {
+                m_stats.sweep(tag, sweep_length);
+                m_stats.rejection(tag);
+                return false;
+            }
+            admitted = true;
+        }
+        return true;
+    };
+    if (m_timers) {
+        m_timers->advance(now_tick());
+    }
+    while (needs_room(sizeof(T))) {
+        if (expire_due()) {
+            continue;
+        }
+        CacheElement & val = m_policy.victim(key_hash, requeue);
+        if (!admits(val)) {
+            return make_transient<T>(key, std::forward<Args>(args)...);
+        }
+        evict(val);
+    }
+    // size class of T can be full while the cache is within its bounds,
+    // then elements are evicted until one of its slots is freed
+    T * added = try_create<T>(key, std::forward<Args>(args)...);
+    while (added == nullptr) {
+        if (m_policy.size() == 0) {
+            throw std::bad_alloc{};
+        }
+        if (!expire_due()) {
+            CacheElement & val = m_policy.victim(key_hash, requeue);
+            if (!admits(val)) {
+                return make_transient<T>(key, std::forward<Args>(args)...);
+            }
+            evict(val);
         }
-        m_queue.pop_back();
+        // args are only used once T is constructed
+        added = try_create<T>(key, std::forward<Args>(args)...);
+    }
+    // memory owned by the element is known only once it's built
+    const std::size_t usage = element_memory_usage(*added);
+    while (needs_room(usage)) {
+        if (expire_due()) {
+            continue;
+        }
+        CacheElement & val = m_policy.victim(key_hash, requeue);
+        sweep_length++;
+        evict(val);
+    }
+    if (sweep_length != 0) {
+        m_stats.sweep(tag, sweep_length);
+    }
+    m_memory_usage += usage;
+    const Handle handle = m_policy.insert(CacheElement(added, key_hash, tag, usage, &snapshot_type<KeyProvider, T>, ++m_use_count), key_hash);
+    if constexpr (indexed) {
+        std::optional<Timer> timer;
+        if (m_default_ttl.count() != 0) {
+            timer = schedule(added, key_hash, m_default_ttl);
+        }
+        m_index.emplace(key_hash, IndexEntry{added, handle, timer});
     }
-    T * added = m_alloc.create<T>(key);
-    m_queue.emplace_front(added);
     return *added;
 }
 
-template <class Key, class KeyProvider, class Allocator>
-inline std::ostream & Cache<Key, KeyProvider, Allocator>::print(std::ostream & strm) const
+template <class Key, class KeyProvider, class Allocator, template <class> class Policy, class Hash>
+template <class T, class K, class... Args>
+inline T * Cache<Key, KeyProvider, Allocator, Policy, Hash>::try_create(const K & key, Args &&... args)
+{
+    if constexpr (sizeof...(Args) != 0) {
+        static_cast<void>(key);
+        return m_alloc.template try_create<T>(std::forward<Args>(args)...);
+    }
+    else if constexpr (std::is_same_v<K, Key>) {
+        return m_alloc.template try_create<T>(key);
+    }
+    else {
+        return m_alloc.template try_create<T>(Key(key));
+    }
+}
+
+template <class Key, class KeyProvider, class Allocator, template <class> class Policy, class Hash>
+template <class T, class K, class... Args>
+inline T & Cache<Key, KeyProvider, Allocator, Policy, Hash>::make_transient(const K & key, Args &&... args)
+{
+    T * result = nullptr;
+    if constexpr (sizeof...(Args) != 0) {
+        result = new T(std::forward<Args>(args)...);
+    }
+    else {
+        result = new T(Key(key));
+    }
+    m_transient = {result, [](KeyProvider * ptr) {
+                       delete static_cast<T *>(ptr);
+                   }};
+    return *result;
+}
+
+template <class Key, class KeyProvider, class Allocator, template <class> class Policy, class Hash>
+template <class K>
+inline auto Cache<Key, KeyProvider, Allocator, Policy, Hash>::lookup(const K & key, const std::size_t key_hash) -> std::optional<Handle>
+{
+    if constexpr (indexed) {
+        const IndexIterator entry = find_entry(key, key_hash);
+        if (entry == m_index.end()) {
+            return std::nullopt;
+        }
+        if (expired(entry->second)) {
+            m_timers->cancel(*entry->second.timer);
+            remove_expired(entry);
+            return std::nullopt;
+        }
+        return entry->second.handle;
+    }
+    else {
+        static_cast<void>(key_hash);
+        return m_policy.find([&key](const CacheElement & val) {
+            return *val.element == key;
+        });
+    }
+}
+
+template <class Key, class KeyProvider, class Allocator, template <class> class Policy, class Hash>
+template <class K>
+inline auto Cache<Key, KeyProvider, Allocator, Policy, Hash>::find_entry(const K & key, const std::size_t key_hash) -> IndexIterator
+{
+    const auto [begin, end] = m_index.equal_range(key_hash);
+    for (auto it = begin; it != end; ++it) {
+        if (*it->second.element == key) {
+            return it;
+        }
+    }
+    return m_index.end();
+}
+
+template <class Key, class KeyProvider, class Allocator, template <class> class Policy, class Hash>
+inline auto Cache<Key, KeyProvider, Allocator, Policy, Hash>::find_element(const std::size_t key_hash, const KeyProvider * element) -> IndexIterator
+{
+    const auto [begin, end] = m_index.equal_range(key_hash);
+    for (auto it = begin; it != end; ++it) {
+        if (it->second.element == element) {
+            return it;
+        }
+    }
+    return m_index.end();
+}
+
+template <class Key, class KeyProvider, class Allocator, template <class> class Policy, class Hash>
+template <class K>
+inline bool Cache<Key, KeyProvider, Allocator, Policy, Hash>::expire_after(const K & key, const std::chrono::milliseconds ttl)
+{
+    static_assert(indexed, "Time to live requires hashable keys");
+    if constexpr (!direct_lookup<K>) {
+        return expire_after<Key>(Key(key), ttl);
+    }
+    else {
+        const std::size_t key_hash = hash(key);
+        const IndexIterator found = find_entry(key, key_hash);
+        if (found == m_index.end()) {
+            return false;
+        }
+        IndexEntry & entry = found->second;
+        if (expired(entry)) {
+            m_timers->cancel(*entry.timer);
+            remove_expired(found);
+            return false;
+        }
+        if (entry.timer) {
+            m_timers->cancel(*entry.timer);
+            entry.timer.reset();
+        }
+        if (ttl.count() != 0) {
+            entry.timer = schedule(entry.element, key_hash, ttl);
+        }
+        return true;
+    }
+}
+
+template <class Key, class KeyProvider, class Allocator, template <class> class Policy, class Hash>
+inline auto Cache<Key, KeyProvider, Allocator, Policy, Hash>::schedule(KeyProvider * element, const std::size_t key_hash, const std::chrono::milliseconds ttl) -> Timer
+{
+    if (!m_timers) {
+        m_timers = std::make_unique<Timers>();
+    }
+    const std::uint64_t now = now_tick();
+    m_timers->advance(now);
+    return m_timers->add(Expiry{element, key_hash}, now + static_cast<std::uint64_t>(ttl.count()));
+}
+
+template <class Key, class KeyProvider, class Allocator, template <class> class Policy, class Hash>
+inline void Cache<Key, KeyProvider, Allocator, Policy, Hash>::remove_expired(const IndexIterator entry)
+{
+    const CacheElement val = m_policy.erase(entry->second.handle);
+    m_index.erase(entry);
+    m_stats.expiration(val.tag);
+    m_memory_usage -= val.usage;
+    m_alloc.template destroy<KeyProvider>(val.element);
+}
+
+template <class Key, class KeyProvider, class Allocator, template <class> class Policy, class Hash>
+inline bool Cache<Key, KeyProvider, Allocator, Policy, Hash>::expire_due()
+{
+    if constexpr (indexed) {
+        if (!m_timers || !m_timers->has_due()) {
+            return false;
+        }
+        const Expiry expiry = m_timers->pop_due();
+        const IndexIterator entry = find_element(expiry.hash, expiry.element);
+        if (entry != m_index.end()) {
+            remove_expired(entry);
+        }
+        return true;
+    }
+    else {
+        return false;
+    }
+}
+
+template <class Key, class KeyProvider, class Allocator, template <class> class Policy, class Hash>
+inline void Cache<Key, KeyProvider, Allocator, Policy, Hash>::unindex(const CacheElement & val)
 {
-    if (m_queue.size() > 0) {
+    if constexpr (indexed) {
+        const IndexIterator entry = find_element(val.hash, val.element);
+        if (entry == m_index.end()) {
+            return;
+        }
+        if (entry->second.timer) {
+            m_timers->cancel(*entry->second.timer);
+        }
+        m_index.erase(entry);
+    }
+    else {
+        static_cast<void>(val);
+    }
+}
+
+template <class Key, class KeyProvider, class Allocator, template <class> class Policy, class Hash>
+template <class K>
+inline std::string Cache<Key, KeyProvider, Allocator, Policy, Hash>::key_bytes(const K & key)
+{
+    std::ostringstream strm;
+    if constexpr (std::is_same_v<K, Key>) {
+        Serializer<Key>::write(strm, key);
+    }
+    else {
+        Serializer<Key>::write(strm, Key(key));
+    }
+    return strm.str();
+}
+
+template <class Key, class KeyProvider, class Allocator, template <class> class Policy, class Hash>
+inline void Cache<Key, KeyProvider, Allocator, Policy, Hash>::spill(const CacheElement & val)
+{
+    if constexpr (spillable) {
+        if (m_spill && val.type->write != nullptr) {
+            std::ostringstream value;
+            Serializer<std::string>::write(value, val.type->name);
+            val.type->write(value, *val.element);
+            m_spill->put(val.hash, key_bytes(val.element->key()), value.str());
+        }
+    }
+    else {
+        static_cast<void>(val);
+    }
+}
+
+template <class Key, class KeyProvider, class Allocator, template <class> class Policy, class Hash>
+template <class T, class K>
+inline T * Cache<Key, KeyProvider, Allocator, Policy, Hash>::restore(const K & key, const std::size_t key_hash)
+{
+    if constexpr (spillable && has_serializer_v<T>) {
+        if (!m_spill) {
+            return nullptr;
+        }
+        const std::string bytes = key_bytes(key);
+        const auto record = m_spill->find(key_hash, bytes);
+        if (!record) {
+            return nullptr;
+        }
+        std::istringstream value{std::string(*record)};
+        value.exceptions(std::ios::failbit | std::ios::badbit);
+        // record of another type is dropped as well, T built for the key replaces it
+        m_spill->erase(key_hash, bytes);
+        if (Serializer<std::string>::read(value) != snapshot_type<KeyProvider, T>.name) {
+            return nullptr;
+        }
+        T restored = Serializer<T>::read(value);
+        m_stats.spill_hit(CacheStatsCollector::tag<T>());
+        // element was in use recently, so it isn't filtered
+        return &insert<T>(key, key_hash, false, std::move(restored));
+    }
+    else {
+        static_cast<void>(key);
+        static_cast<void>(key_hash);
+        return nullptr;
+    }
+}
+
+template <class Key, class KeyProvider, class Allocator, template <class> class Policy, class Hash>
+inline void Cache<Key, KeyProvider, Allocator, Policy, Hash>::dump(const std::string & path) const
+{
+    static_assert(has_serializer_v<Key>, "Key has to have a Serializer");
+    static_assert(has_key_v<KeyProvider, Key>, "KeyProvider has to return its key with key()");
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error("can't open " + path);
+    }
+    file.exceptions(std::ios::failbit | std::ios::badbit);
+    file.write(snapshot_magic, sizeof(snapshot_magic));
+    Serializer<std::uint64_t>::write(file, m_policy.size());
+    // policies with several queues list them one after another,
+    // so elements are ordered by their last access instead
+    std::vector<std::pair<const CacheElement *, bool>> elements;
+    elements.reserve(m_policy.size());
+    m_policy.for_each([&elements](const CacheElement & val, const bool referenced) {
+        elements.emplace_back(&val, referenced);
+    });
+    std::sort(elements.begin(), elements.end(), [](const auto & lhs, const auto & rhs) {
+        return lhs.first->last_use > rhs.first->last_use;
+    });
+    std::ostringstream payload;
+    for (const auto & [element, referenced] : elements) {
+        const CacheElement & val = *element;
+        Serializer<Key>::write(file, val.element->key());
+        Serializer<bool>::write(file, referenced);
+        Serializer<std::string>::write(file, val.type->name);
+        payload.str({});
+        if (val.type->write != nullptr) {
+            val.type->write(payload, *val.element);
+        }
+        Serializer<bool>::write(file, val.type->write != nullptr);
+        Serializer<std::string>::write(file, payload.str());
+    }
+}
+
+template <class Key, class KeyProvider, class Allocator, template <class> class Policy, class Hash>
+template <class T, class Loader>
+inline std::size_t Cache<Key, KeyProvider, Allocator, Policy, Hash>::warm(const std::string & path, Loader && loader, const std::size_t workers_count)
+{
+    static_assert(has_serializer_v<Key>, "Key has to have a Serializer");
+    static_assert(std::is_base_of_v<KeyProvider, T>, "Key has to be the base class of KeyProvider");
+    static_assert(std::is_invocable_r_v<T, Loader &, const Key &>, "Loader has to build T from Key");
+    struct Record
+    {
+        Key key;
+        bool referenced;
+        std::optional<std::string> payload;
+        std::optional<T> value;
+    };
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("can't open " + path);
+    }
+    file.exceptions(std::ios::failbit | std::ios::badbit | std::ios::eofbit);
+    char magic[sizeof(snapshot_magic)];
+    file.read(magic, sizeof(magic));
+    if (std::memcmp(magic, snapshot_magic, sizeof(magic)) != 0) {
+        throw std::runtime_error(path + " isn't a cache dump");
+    }
+    std::vector<Record> records;
+    const std::uint64_t count = Serializer<std::uint64_t>::read(file);
+    for (std::uint64_t i = 0; i < count; i++) {
+        Key key = Serializer<Key>::read(file);
+        const bool referenced = Serializer<bool>::read(file);
+        const bool stored = Serializer<std::string>::read(file) == snapshot_type<KeyProvider, T>.name;
+        const bool has_payload = Serializer<bool>::read(file);
+        std::string payload = Serializer<std::string>::read(file);
+        if (stored) {
+            records.push_back({std::move(key), referenced, std::nullopt, std::nullopt});
+            if (has_payload) {
+                records.back().payload = std::move(payload);
+            }
+        }
+    }
+
+    std::vector<std::exception_ptr> errors(records.size());
+    {
+        ThreadPool workers(std::min(workers_count, records.size()));
+        for (std::size_t i = 0; i < records.size(); i++) {
+            workers.submit([&records, &errors, &loader, i] {
+                Record & record = records[i];
+                try {
+                    if constexpr (has_serializer_v<T>) {
+                        if (record.payload) {
+                            std::istringstream payload(*record.payload);
+                            payload.exceptions(std::ios::failbit | std::ios::badbit);
+                            record.value.emplace(Serializer<T>::read(payload));
+                            return;
+                        }
+                    }
+                    record.value.emplace(loader(record.key));
+                }
+                catch (...) {
+                    errors[i] = std::current_exception();
+                }
+            });
+        }
+    }
+    for (const auto & error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    for (auto it = records.rbegin(); it != records.rend(); ++it) {
+        const std::size_t key_hash = hash(it->key);
+        if (!lookup(it->key, key_hash)) {
+            insert<T>(it->key, key_hash, false, std::move(*it->value));
+        }
+        const auto found = lookup(it->key, key_hash);
+        if (found && it->referenced) {
+            m_policy.hit(*found);
+        }
+    }
+    return records.size();
+}
+
+template <class Key, class KeyProvider, class Allocator, template <class> class Policy, class Hash>
+inline std::ostream & Cache<Key, KeyProvider, Allocator, Policy, Hash>::print(std::ostream & strm) const
+{
+    if (m_policy.size() > 0) {
         bool first = true;
-        for (const auto ptr : m_queue) {
+        m_policy.for_each([&strm, &first](const CacheElement & val, const bool flag) {
             if (!first) {
                 strm << " ";
             }
             else {
                 first = false;
             }
-            strm << "(" << *ptr.element << " " << ptr.flag << ")";
-        }
+            strm << "(" << *val.element << " " << flag << ")";
+        });
         return strm << "\n";
     }
     else {
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+/**
+ * Counters of a cache (or of one element type in it)
+ */
+struct CacheStats
+{
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+    std::size_t evictions = 0;
+    // elements removed once their time to live ran out
+    std::size_t expirations = 0;
+    // misses not cached by admission filter
+    std::size_t rejections = 0;
+    // misses, that were found in the spill file
+    std::size_t spill_hits = 0;
+    // elements given a second chance while looking for a victim
+    std::size_t requeues = 0;
+    // evictions sweeps and total amount of elements they examined
+    std::size_t sweeps = 0;
+    std::size_t sweep_length = 0;
+
+    double hit_ratio() const
+    {
+        return hits + misses == 0 ? 0 : static_cast<double>(hits) / static_cast<double>(hits + misses);
+    }
+
+    double requeues_per_eviction() const
+    {
+        return evictions == 0 ? 0 : static_cast<double>(requeues) / static_cast<double>(evictions);
+    }
+
+    double average_sweep_length() const
+    {
+        return sweeps == 0 ? 0 : static_cast<double>(sweep_length) / static_cast<double>(sweeps);
+    }
+
+    CacheStats & operator+=(const CacheStats & other)
+    {
+        hits += other.hits;
+        misses += other.misses;
+        evictions += other.evictions;
+        expirations += other.expirations;
+        rejections += other.rejections;
+        spill_hits += other.spill_hits;
+        requeues += other.requeues;
+        sweeps += other.sweeps;
+        sweep_length += other.sweep_length;
+        return *this;
+    }
+
+    friend std::ostream & operator<<(std::ostream & strm, const CacheStats & stats)
+    {
+        return strm << "hits " << stats.hits
+                    << " misses " << stats.misses
+                    << " hit_ratio " << stats.hit_ratio()
+                    << " evictions " << stats.evictions
+                    << " expirations " << stats.expirations
+                    << " rejections " << stats.rejections
+                    << " spill_hits " << stats.spill_hits
+                    << " requeues_per_eviction " << stats.requeues_per_eviction()
+                    << " average_sweep_length " << stats.average_sweep_length();
+    }
+};
+
+/**
+ * Copy of cache counters, in total and per element type
+ * (hits and misses go to the requested type, evictions and
+ * requeues to the type of the element they happened to)
+ */
+struct CacheStatsSnapshot
+{
+    CacheStats total;
+    std::map<std::string, CacheStats> per_type;
+
+    CacheStatsSnapshot & operator+=(const CacheStatsSnapshot & other)
+    {
+        total += other.total;
+        for (const auto & [name, stats] : other.per_type) {
+            per_type[name] += stats;
+        }
+        return *this;
+    }
+
+    friend std::ostream & operator<<(std::ostream & strm, const CacheStatsSnapshot & snapshot)
+    {
+        strm << "total: " << snapshot.total << "\n";
+        for (const auto & [name, stats] : snapshot.per_type) {
+            strm << name << ": " << stats << "\n";
+        }
+        return strm;
+    }
+};
+
+#ifdef CACHE_STATS
+
+/**
+ * Collects cache counters, compiled in only with CACHE_STATS defined
+ */
+class CacheStatsCollector
+{
+public:
+    // identifies element type, is stored with every element
+    using Tag = const std::type_info *;
+
+    template <class T>
+    static Tag tag()
+    {
+        return &typeid(T);
+    }
+
+    void hit(const Tag tag) { at(tag).hits++; }
+    void miss(const Tag tag) { at(tag).misses++; }
+    void eviction(const Tag tag) { at(tag).evictions++; }
+    void expiration(const Tag tag) { at(tag).expirations++; }
+    void rejection(const Tag tag) { at(tag).rejections++; }
+    void spill_hit(const Tag tag) { at(tag).spill_hits++; }
+    void requeue(const Tag tag) { at(tag).requeues++; }
+
+    void sweep(const Tag tag, const std::size_t length)
+    {
+        CacheStats & stats = at(tag);
+        stats.sweeps++;
+        stats.sweep_length += length;
+    }
+
+    CacheStatsSnapshot snapshot() const
+    {
+        CacheStatsSnapshot result;
+        for (const auto & [tag, stats] : m_stats) {
+            result.total += stats;
+            result.per_type[tag->name()] += stats;
+        }
+        return result;
+    }
+
+private:
+    CacheStats & at(const Tag tag)
+    {
+        // there are only a few types in a cache, linear search is faster than hashing
+        for (auto & [type, stats] : m_stats) {
+            if (type == tag) {
+                return stats;
+            }
+        }
+        return m_stats.emplace_back(tag, CacheStats{}).second;
+    }
+
+    std::vector<std::pair<Tag, CacheStats>> m_stats;
+};
+
+#else
+
+class CacheStatsCollector
+{
+public:
+    struct Tag
+    {
+    };
+
+    template <class T>
+    static Tag tag()
+    {
+        return {};
+    }
+
+    void hit(const Tag) {}
+    void miss(const Tag) {}
+    void eviction(const Tag) {}
+    void expiration(const Tag) {}
+    void rejection(const Tag) {}
+    void spill_hit(const Tag) {}
+    void requeue(const Tag) {}
+    void sweep(const Tag, const std::size_t) {}
+
+    CacheStatsSnapshot snapshot() const
+    {
+        return {};
+    }
+};
+
+#endif
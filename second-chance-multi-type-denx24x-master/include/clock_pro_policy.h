@@ -0,0 +1,273 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <list>
+#include <optional>
+#include <unordered_map>
+
+/**
+ * CLOCK-Pro (Jiang, Chen, Zhang, USENIX'05): entries on a single clock are
+ * hot or cold, cold ones get a test period, and evicted cold entries in the
+ * test period stay on the clock as non-resident. A miss on such an entry
+ * brings it back hot and grows the share of cold entries, an expired test
+ * period shrinks it. Three hands sweep the clock:
+ *  - cold hand looks for a victim among resident cold entries
+ *  - hot hand demotes unused hot entries and ends test periods
+ *  - test hand ends test periods to bound the non-resident entries
+ * Interface is described in second_chance_policy.h.
+ */
+template <class Entry>
+class ClockProPolicy
+{
+    struct Node
+    {
+        Entry entry;
+        std::size_t hash;
+        bool resident = true;
+        bool hot = false;
+        bool referenced = false;
+        bool test = false;
+    };
+
+    using Iterator = typename std::list<Node>::iterator;
+
+public:
+    using Handle = Iterator;
+
+    static constexpr bool uses_history = true;
+
+    ClockProPolicy(const std::size_t capacity)
+        : m_capacity(std::max<std::size_t>(1, capacity))
+        , m_cold_target(std::max<std::size_t>(1, capacity / 2))
+    {
+    }
+
+    std::size_t size() const
+    {
+        return m_hot_count + m_cold_count;
+    }
+
+    template <class Pred>
+    std::optional<Handle> find(Pred && pred)
+    {
+        for (auto it = m_clock.begin(); it != m_clock.end(); ++it) {
+            if (it->resident && pred(it->entry)) {
+                return it;
+            }
+        }
+        return std::nullopt;
+    }
+
+    Entry & hit(const Handle handle)
+    {
+        handle->referenced = true;
+        return handle->entry;
+    }
+
+    void miss(const std::size_t)
+    {
+    }
+
+    template <class Requeue>
+    Entry & victim(const std::size_t, Requeue && requeue)
+    {
+        while (true) {
+            if (m_cold_count == 0) {
+                run_hot_hand();
+                continue;
+            }
+            const Iterator current = m_cold_hand;
+            if (current->resident && !current->hot && !current->referenced) {
+                // hand stays here, so victim, that wasn't removed, is found again at once
+                m_victim = current;
+                return current->entry;
+            }
+            advance(m_cold_hand);
+            if (!current->resident || current->hot) {
+                continue;
+            }
+            current->referenced = false;
+            requeue(current->entry);
+            if (current->test) {
+                // reused within the test period
+                current->hot = true;
+                current->test = false;
+                m_cold_count--;
+                m_hot_count++;
+                move_to_head(current);
+                balance_hot();
+            }
+            else {
+                current->test = true;
+                move_to_head(current);
+            }
+        }
+    }
+
+    void remove_victim()
+    {
+        m_victim->resident = false;
+        m_cold_count--;
+        if (m_victim->test) {
+            m_nonresident.insert_or_assign(m_victim->hash, m_victim);
+            while (m_nonresident.size() > m_capacity) {
+                run_test_hand();
+            }
+        }
+        else {
+            remove(m_victim);
+        }
+    }
+
+    Handle insert(const Entry & entry, const std::size_t hash)
+    {
+        bool hot = false;
+        const auto ghost = m_nonresident.find(hash);
+        if (ghost != m_nonresident.end()) {
+            // missed within the test period, cold entries need more room
+            hot = true;
+            m_cold_target = std::min(m_capacity, m_cold_target + 1);
+            remove(ghost->second);
+        }
+        const Iterator added = m_clock.insert(m_clock.empty() ? m_clock.end() : m_hot_hand, Node{entry, hash});
+        if (m_clock.size() == 1) {
+            m_hot_hand = m_cold_hand = m_test_hand = added;
+        }
+        if (hot) {
+            added->hot = true;
+            m_hot_count++;
+            balance_hot();
+        }
+        else {
+            added->test = true;
+            m_cold_count++;
+        }
+        return added;
+    }
+
+    Entry erase(const Handle handle)
+    {
+        Entry result = handle->entry;
+        if (handle->hot) {
+            m_hot_count--;
+        }
+        else {
+            m_cold_count--;
+        }
+        remove(handle);
+        return result;
+    }
+
+    template <class Func>
+    void for_each(Func && func) const
+    {
+        for (const auto & node : m_clock) {
+            if (node.resident) {
+                func(node.entry, node.referenced);
+            }
+        }
+    }
+
+private:
+    void advance(Iterator & hand)
+    {
+        if (++hand == m_clock.end()) {
+            hand = m_clock.begin();
+        }
+    }
+
+    // removes node from the clock, moving hands pointing to it forward
+    void unlink(const Iterator node)
+    {
+        for (Iterator * hand : {&m_hot_hand, &m_cold_hand, &m_test_hand}) {
+            if (*hand == node) {
+                advance(*hand);
+            }
+        }
+    }
+
+    void move_to_head(const Iterator node)
+    {
+        unlink(node);
+        if (node != m_hot_hand) {
+            m_clock.splice(m_hot_hand, m_clock, node);
+        }
+    }
+
+    void remove(const Iterator node)
+    {
+        const auto indexed = m_nonresident.find(node->hash);
+        if (indexed != m_nonresident.end() && indexed->second == node) {
+            m_nonresident.erase(indexed);
+        }
+        unlink(node);
+        m_clock.erase(node);
+    }
+
+    void end_test(const Iterator node)
+    {
+        node->test = false;
+        m_cold_target = std::max<std::size_t>(1, m_cold_target - 1);
+    }
+
+    void balance_hot()
+    {
+        while (m_hot_count > 0 && m_hot_count > m_capacity - m_cold_target) {
+            run_hot_hand();
+        }
+    }
+
+    // demotes one unused hot entry
+    void run_hot_hand()
+    {
+        while (true) {
+            const Iterator current = m_hot_hand;
+            advance(m_hot_hand);
+            if (current->hot) {
+                if (current->referenced) {
+                    current->referenced = false;
+                    continue;
+                }
+                current->hot = false;
+                m_hot_count--;
+                m_cold_count++;
+                return;
+            }
+            if (current->test) {
+                end_test(current);
+                if (!current->resident) {
+                    remove(current);
+                }
+            }
+        }
+    }
+
+    // ends test period of one non-resident entry
+    void run_test_hand()
+    {
+        while (true) {
+            const Iterator current = m_test_hand;
+            advance(m_test_hand);
+            if (!current->hot && current->test) {
+                end_test(current);
+                if (!current->resident) {
+                    remove(current);
+                    return;
+                }
+            }
+        }
+    }
+
+    const std::size_t m_capacity;
+    std::size_t m_cold_target;
+    std::size_t m_hot_count = 0;
+    std::size_t m_cold_count = 0;
+    std::list<Node> m_clock;
+    std::unordered_map<std::size_t, Iterator> m_nonresident;
+    Iterator m_hot_hand;
+    Iterator m_cold_hand;
+    Iterator m_test_hand;
+    Iterator m_victim;
+};
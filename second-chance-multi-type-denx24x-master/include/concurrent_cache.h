@@ -0,0 +1,361 @@
+#pragma once
+
+#include "epoch.h"
+#include "key_hash.h"
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * Second chance cache with lock-free hits.
+ *
+ * Elements are indexed by an open addressing hash table, that readers probe
+ * without locking and mark found element as used with an atomic store.
+ * Misses and evictions are serialized by a mutex. Evicted elements are
+ * destroyed only when no reader can hold them anymore (see EpochDomain).
+ *
+ * Because of deferred destruction the pool should have some headroom over
+ * cache size, otherwise a miss waits for readers to leave their epoch.
+ */
+template <class Key, class KeyProvider, class Allocator, class Hash = KeyHash<Key>>
+class ConcurrentCache
+{
+    static_assert(std::is_constructible_v<KeyProvider, const Key &>, "KeyProvider has to be constructible from Key");
+
+    struct Node
+    {
+        Node(KeyProvider * val, const std::size_t key_hash)
+            : element(val)
+            , hash(key_hash)
+        {
+        }
+
+        KeyProvider * const element;
+        const std::size_t hash;
+        std::atomic<bool> flag{false};
+    };
+
+    struct Table
+    {
+        Table(const std::size_t size)
+            : slots(size)
+            , mask(size - 1)
+        {
+        }
+
+        std::vector<std::atomic<Node *>> slots;
+        const std::size_t mask;
+    };
+
+public:
+    template <class... AllocArgs>
+    ConcurrentCache(const std::size_t cache_size, AllocArgs &&... alloc_args)
+        : m_max_size(cache_size)
+        , m_alloc(std::forward<AllocArgs>(alloc_args)...)
+        , m_table(new Table(table_size(cache_size)))
+    {
+    }
+
+    ConcurrentCache(const ConcurrentCache &) = delete;
+    ConcurrentCache & operator=(const ConcurrentCache &) = delete;
+
+    ~ConcurrentCache();
+
+    std::size_t size() const
+    {
+        std::lock_guard lock(m_mutex);
+        return m_queue.size();
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    std::size_t capacity() const
+    {
+        return m_max_size;
+    }
+
+    /**
+     * Looks up (or creates) element of type T for the key and calls func(T &),
+     * the element is guaranteed to stay alive only until func returns.
+     * Hits don't take any locks. Func must not call get() of the same cache.
+     * Key can be of any type the hash and KeyProvider::operator== accept,
+     * then Key is built only to create a new element.
+     */
+    template <class T, class K, class Func>
+    decltype(auto) get(const K & key, Func && func);
+
+    std::ostream & print(std::ostream & strm) const;
+
+    friend std::ostream & operator<<(std::ostream & strm, const ConcurrentCache & cache)
+    {
+        return cache.print(strm);
+    }
+
+private:
+    static std::size_t table_size(const std::size_t cache_size)
+    {
+        std::size_t result = 2;
+        while (result < cache_size * 2) {
+            result *= 2;
+        }
+        return result;
+    }
+
+    template <class T, class K, class Func>
+    decltype(auto) find_or_insert(const K & key, Func && func);
+
+    template <class K>
+    Node * find(const Table & table, const std::size_t hash, const K & key) const;
+
+    template <class T, class K>
+    Node * insert(const std::size_t hash, const K & key);
+
+    void evict();
+    void unlink(Node * node);
+    void rehash();
+    void reclaim();
+
+    const std::size_t m_max_size;
+    Hash m_hash;
+    Node m_tombstone{nullptr, 0};
+
+    // writers' state, guarded by m_mutex
+    mutable std::mutex m_mutex;
+    std::deque<Node *> m_queue;
+    std::size_t m_tombstones_count = 0;
+    std::vector<std::pair<std::size_t, Node *>> m_retired_nodes;
+    std::vector<std::pair<std::size_t, std::unique_ptr<Table>>> m_retired_tables;
+    Allocator m_alloc;
+
+    std::atomic<Table *> m_table;
+    EpochDomain m_epoch;
+};
+
+template <class Key, class KeyProvider, class Allocator, class Hash>
+ConcurrentCache<Key, KeyProvider, Allocator, Hash>::~ConcurrentCache()
+{
+    for (const auto node : m_queue) {
+        m_alloc.template destroy<KeyProvider>(node->element);
+        delete node;
+    }
+    for (const auto & [epoch, node] : m_retired_nodes) {
+        m_alloc.template destroy<KeyProvider>(node->element);
+        delete node;
+    }
+    delete m_table.load();
+}
+
+template <class Key, class KeyProvider, class Allocator, class Hash>
+template <class T, class K, class Func>
+inline decltype(auto) ConcurrentCache<Key, KeyProvider, Allocator, Hash>::get(const K & key, Func && func)
+{
+    static_assert(std::is_base_of_v<KeyProvider, T>, "Key has to be the base class of KeyProvider");
+    if constexpr (!std::is_same_v<K, Key> && !is_lookup_key_v<K, KeyProvider, Hash>) {
+        return get<T, Key>(Key(key), std::forward<Func>(func));
+    }
+    else {
+        return find_or_insert<T>(key, std::forward<Func>(func));
+    }
+}
+
+template <class Key, class KeyProvider, class Allocator, class Hash>
+template <class T, class K, class Func>
+inline decltype(auto) ConcurrentCache<Key, KeyProvider, Allocator, Hash>::find_or_insert(const K & key, Func && func)
+{
+    const std::size_t hash = m_hash(key);
+    {
+        const auto guard = m_epoch.pin();
+        if (Node * node = find(*m_table.load(std::memory_order_acquire), hash, key)) {
+            // don't dirty the cache line of an already used element
+            if (!node->flag.load(std::memory_order_relaxed)) {
+                node->flag.store(true, std::memory_order_relaxed);
+            }
+            return std::forward<Func>(func)(*static_cast<T *>(node->element));
+        }
+    }
+
+    std::unique_lock lock(m_mutex);
+    Node * node = find(*m_table.load(std::memory_order_relaxed), hash, key);
+    if (node != nullptr) {
+        node->flag.store(true, std::memory_order_relaxed);
+    }
+    else {
+        node = insert<T>(hash, key);
+    }
+    // pinned before unlocking, so the node can't be reclaimed under func
+    const auto guard = m_epoch.pin();
+    lock.unlock();
+    return std::forward<Func>(func)(*static_cast<T *>(node->element));
+}
+
+template <class Key, class KeyProvider, class Allocator, class Hash>
+template <class K>
+inline typename ConcurrentCache<Key, KeyProvider, Allocator, Hash>::Node * ConcurrentCache<Key, KeyProvider, Allocator, Hash>::find(const Table & table, const std::size_t hash, const K & key) const
+{
+    for (std::size_t i = hash & table.mask, probes = 0; probes < table.slots.size(); i = (i + 1) & table.mask, probes++) {
+        Node * node = table.slots[i].load(std::memory_order_acquire);
+        if (node == nullptr) {
+            return nullptr;
+        }
+        if (node != &m_tombstone && node->hash == hash && *node->element == key) {
+            return node;
+        }
+    }
+    return nullptr;
+}
+
+template <class Key, class KeyProvider, class Allocator, class Hash>
+template <class T, class K>
+inline typename ConcurrentCache<Key, KeyProvider, Allocator, Hash>::Node * ConcurrentCache<Key, KeyProvider, Allocator, Hash>::insert(const std::size_t hash, const K & key)
+{
+    reclaim();
+    while (m_queue.size() == m_max_size) {
+        evict();
+    }
+
+    T * added = nullptr;
+    while (added == nullptr) {
+        try {
+            if constexpr (std::is_same_v<K, Key>) {
+                added = m_alloc.template create<T>(key);
+            }
+            else {
+                added = m_alloc.template create<T>(Key(key));
+            }
+        }
+        catch (const std::bad_alloc &) {
+            // pool is full of evicted elements, that are still visible to readers
+            if (m_retired_nodes.empty()) {
+                throw;
+            }
+            std::this_thread::yield();
+            reclaim();
+        }
+    }
+    auto node = std::make_unique<Node>(added, hash);
+
+    if ((m_queue.size() + m_tombstones_count + 1) * 4 > m_table.load(std::memory_order_relaxed)->slots.size() * 3) {
+        rehash();
+    }
+    Table & table = *m_table.load(std::memory_order_relaxed);
+    std::size_t i = hash & table.mask;
+    while (true) {
+        Node * current = table.slots[i].load(std::memory_order_relaxed);
+        if (current == nullptr) {
+            break;
+        }
+        if (current == &m_tombstone) {
+            m_tombstones_count--;
+            break;
+        }
+        i = (i + 1) & table.mask;
+    }
+    table.slots[i].store(node.get(), std::memory_order_release);
+    m_queue.push_front(node.get());
+    return node.release();
+}
+
+template <class Key, class KeyProvider, class Allocator, class Hash>
+inline void ConcurrentCache<Key, KeyProvider, Allocator, Hash>::evict()
+{
+    Node * node = m_queue.back();
+    m_queue.pop_back();
+    if (node->flag.load(std::memory_order_relaxed)) {
+        node->flag.store(false, std::memory_order_relaxed);
+        m_queue.push_front(node);
+    }
+    else {
+        unlink(node);
+        m_retired_nodes.emplace_back(m_epoch.epoch(), node);
+    }
+}
+
+template <class Key, class KeyProvider, class Allocator, class Hash>
+inline void ConcurrentCache<Key, KeyProvider, Allocator, Hash>::unlink(Node * node)
+{
+    Table & table = *m_table.load(std::memory_order_relaxed);
+    std::size_t i = node->hash & table.mask;
+    while (table.slots[i].load(std::memory_order_relaxed) != node) {
+        i = (i + 1) & table.mask;
+    }
+    table.slots[i].store(&m_tombstone, std::memory_order_release);
+    m_tombstones_count++;
+}
+
+template <class Key, class KeyProvider, class Allocator, class Hash>
+inline void ConcurrentCache<Key, KeyProvider, Allocator, Hash>::rehash()
+{
+    Table * old_table = m_table.load(std::memory_order_relaxed);
+    auto table = std::make_unique<Table>(old_table->slots.size());
+    for (const auto node : m_queue) {
+        std::size_t i = node->hash & table->mask;
+        while (table->slots[i].load(std::memory_order_relaxed) != nullptr) {
+            i = (i + 1) & table->mask;
+        }
+        table->slots[i].store(node, std::memory_order_relaxed);
+    }
+    m_table.store(table.release(), std::memory_order_release);
+    m_tombstones_count = 0;
+    // readers might still probe the old table
+    m_retired_tables.emplace_back(m_epoch.epoch(), old_table);
+}
+
+template <class Key, class KeyProvider, class Allocator, class Hash>
+inline void ConcurrentCache<Key, KeyProvider, Allocator, Hash>::reclaim()
+{
+    if (m_retired_nodes.empty() && m_retired_tables.empty()) {
+        return;
+    }
+    m_epoch.try_advance();
+    std::size_t kept = 0;
+    for (const auto & retired : m_retired_nodes) {
+        if (m_epoch.can_reclaim(retired.first)) {
+            m_alloc.template destroy<KeyProvider>(retired.second->element);
+            delete retired.second;
+        }
+        else {
+            m_retired_nodes[kept++] = retired;
+        }
+    }
+    m_retired_nodes.resize(kept);
+    kept = 0;
+    for (auto & retired : m_retired_tables) {
+        if (!m_epoch.can_reclaim(retired.first)) {
+            std::swap(m_retired_tables[kept++], retired);
+        }
+    }
+    m_retired_tables.resize(kept);
+}
+
+template <class Key, class KeyProvider, class Allocator, class Hash>
+inline std::ostream & ConcurrentCache<Key, KeyProvider, Allocator, Hash>::print(std::ostream & strm) const
+{
+    std::lock_guard lock(m_mutex);
+    if (m_queue.empty()) {
+        return strm << "<empty>\n";
+    }
+    bool first = true;
+    for (const auto node : m_queue) {
+        if (!first) {
+            strm << " ";
+        }
+        else {
+            first = false;
+        }
+        strm << "(" << *node->element << " " << node->flag.load(std::memory_order_relaxed) << ")";
+    }
+    return strm << "\n";
+}
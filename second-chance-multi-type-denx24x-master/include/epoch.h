@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+/**
+ * Epoch based reclamation for lock-free readers.
+ *
+ * Readers pin the current epoch for the time they access shared objects.
+ * A writer that unlinks an object retires it with the current epoch and
+ * may free it once the epoch has advanced by two: by then every reader
+ * that could have seen the object has unpinned.
+ * Readers are counted per epoch parity in striped counters, so pinning
+ * doesn't require registering threads.
+ */
+class EpochDomain
+{
+public:
+    class Guard
+    {
+    public:
+        Guard(const Guard &) = delete;
+        Guard & operator=(const Guard &) = delete;
+        Guard(Guard && other) noexcept;
+        Guard & operator=(Guard &&) = delete;
+        ~Guard();
+
+    private:
+        friend class EpochDomain;
+        Guard(std::atomic<std::size_t> * readers);
+
+        std::atomic<std::size_t> * m_readers;
+    };
+
+    EpochDomain() = default;
+    EpochDomain(const EpochDomain &) = delete;
+    EpochDomain & operator=(const EpochDomain &) = delete;
+
+    /**
+     * Pins current epoch until returned guard is destroyed
+     */
+    Guard pin();
+
+    std::size_t epoch() const;
+
+    /**
+     * Moves to the next epoch if no reader is left in the previous one,
+     * returns true on success
+     */
+    bool try_advance();
+
+    /**
+     * Checks whether an object retired at the given epoch can be freed
+     */
+    bool can_reclaim(const std::size_t retired) const;
+
+private:
+    static constexpr std::size_t stripes_count = 32;
+
+    struct alignas(64) Stripe
+    {
+        std::atomic<std::size_t> readers[2] = {};
+    };
+
+    alignas(64) std::atomic<std::size_t> m_epoch{0};
+    Stripe m_stripes[stripes_count];
+};
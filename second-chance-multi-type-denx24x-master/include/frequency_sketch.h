@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Count-min sketch of 4-bit access counters (as in TinyLFU).
+ * After sample_size increments all counters are halved,
+ * so old popularity fades away.
+ */
+class FrequencySketch
+{
+public:
+    FrequencySketch(const std::size_t capacity);
+
+    void increment(const std::size_t hash);
+    std::uint8_t frequency(const std::size_t hash) const;
+
+private:
+    static constexpr std::size_t depth = 4;
+    static constexpr std::uint8_t max_frequency = 15;
+
+    std::size_t index(const std::size_t hash, const std::size_t row) const;
+    std::uint8_t counter(const std::size_t index) const;
+    void set_counter(const std::size_t index, const std::uint8_t value);
+    void age();
+
+    const std::size_t m_width;
+    const std::size_t m_sample_size;
+    std::size_t m_increments = 0;
+    // two counters per byte, the even one in the low half
+    std::vector<std::uint8_t> m_counters;
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+
+/**
+ * History of evicted keys (their hashes) in eviction order,
+ * used by policies that adapt to re-references of evicted keys
+ */
+class GhostList
+{
+public:
+    std::size_t size() const
+    {
+        return m_order.size();
+    }
+
+    bool empty() const
+    {
+        return m_order.empty();
+    }
+
+    bool contains(const std::size_t hash) const
+    {
+        return m_index.find(hash) != m_index.end();
+    }
+
+    /**
+     * Adds hash as the most recent one
+     */
+    void push(const std::size_t hash)
+    {
+        erase(hash);
+        m_order.push_front(hash);
+        m_index.emplace(hash, m_order.begin());
+    }
+
+    void erase(const std::size_t hash)
+    {
+        const auto it = m_index.find(hash);
+        if (it != m_index.end()) {
+            m_order.erase(it->second);
+            m_index.erase(it);
+        }
+    }
+
+    void pop_oldest()
+    {
+        m_index.erase(m_order.back());
+        m_order.pop_back();
+    }
+
+    void trim(const std::size_t max_size)
+    {
+        while (m_order.size() > max_size) {
+            pop_oldest();
+        }
+    }
+
+private:
+    std::list<std::size_t> m_order;
+    std::unordered_map<std::size_t, std::list<std::size_t>::iterator> m_index;
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+/**
+ * Default hash of cache keys. For std::string it's transparent: string-like
+ * values (std::string_view, const char *) hash equally to the std::string
+ * with the same content, so lookup doesn't have to build the key.
+ */
+template <class Key>
+struct KeyHash : std::hash<Key>
+{
+};
+
+template <>
+struct KeyHash<std::string>
+{
+    using is_transparent = void;
+
+    std::size_t operator()(const std::string_view key) const
+    {
+        return std::hash<std::string_view>{}(key);
+    }
+};
+
+/**
+ * Checks whether cache can look up an element by value of type K without
+ * building Key: Hash has to accept K and KeyProvider has to be comparable to it
+ */
+template <class K, class KeyProvider, class Hash, class = void>
+struct is_lookup_key : std::false_type
+{
+};
+
+template <class K, class KeyProvider, class Hash>
+struct is_lookup_key<K, KeyProvider, Hash, std::void_t<decltype(std::declval<const KeyProvider &>() == std::declval<const K &>())>>
+    : std::bool_constant<std::is_default_constructible_v<Hash> && std::is_invocable_r_v<std::size_t, const Hash &, const K &>>
+{
+};
+
+template <class K, class KeyProvider, class Hash>
+inline constexpr bool is_lookup_key_v = is_lookup_key<K, KeyProvider, Hash>::value;
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+
+/**
+ * Pool allocator for multithreaded use, built after Bonwick's magazines.
+ *
+ * Every thread keeps two magazines (stacks of free slots) per size class
+ * and allocates from them without any synchronization. Only when both of
+ * them are empty (or full, on deallocation) the thread exchanges a whole
+ * magazine with the shared depot of the class, which is guarded by a lock.
+ * Slots freed by another thread return to the pool through the depot too.
+ *
+ * Up to 2 * magazine_size free slots of every class may stay in the cache
+ * of an idle thread, so pools need some headroom for that.
+ */
+class MagazinePoolAllocator
+{
+public:
+    static constexpr std::size_t default_magazine_size = 16;
+
+    MagazinePoolAllocator(const std::size_t block_size, std::initializer_list<std::size_t> sizes, const std::size_t magazine_size = default_magazine_size);
+    void * allocate(const std::size_t n);
+    // nullptr instead of std::bad_alloc if the size class of n is full
+    void * try_allocate(const std::size_t n);
+    void deallocate(const void * ptr);
+
+private:
+    struct Depot;
+    struct ThreadCache;
+
+    ThreadCache & thread_cache() const;
+
+    std::shared_ptr<Depot> m_depot;
+};
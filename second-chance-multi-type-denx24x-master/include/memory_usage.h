@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+/**
+ * Checks whether T reports memory it owns outside of the object itself
+ * (heap buffers, etc.) with `std::size_t memory_usage() const`
+ */
+template <class T, class = void>
+struct has_memory_usage : std::false_type
+{
+};
+
+template <class T>
+struct has_memory_usage<T, std::void_t<decltype(std::declval<const T &>().memory_usage())>>
+    : std::is_convertible<decltype(std::declval<const T &>().memory_usage()), std::size_t>
+{
+};
+
+template <class T>
+inline constexpr bool has_memory_usage_v = has_memory_usage<T>::value;
+
+/**
+ * Bytes a cached element takes: its pool slot, that is exactly sizeof(T)
+ * in PoolAllocator, plus memory_usage() if T has one
+ */
+template <class T>
+std::size_t element_memory_usage(const T & value)
+{
+    if constexpr (has_memory_usage_v<T>) {
+        return sizeof(T) + value.memory_usage();
+    }
+    else {
+        static_cast<void>(value);
+        return sizeof(T);
+    }
+}
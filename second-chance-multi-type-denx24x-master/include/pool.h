@@ -1,20 +1,71 @@
 #pragma once
 
+#include <cstddef>
 #include <functional> // std::less_equal
 #include <initializer_list>
 #include <vector>
 
+/**
+ * Backing storage options of PoolAllocator
+ */
+struct PoolStorage
+{
+    enum class Pages
+    {
+        Regular,
+        // transparent huge pages, requested with madvise
+        Transparent,
+        // MAP_HUGETLB pages reserved by the system, transparent ones if there are none left
+        Huge,
+    };
+
+    Pages pages = Pages::Regular;
+    // NUMA node the memory is bound to, negative leaves placement to the kernel
+    int numa_node = -1;
+};
+
+/**
+ * Anonymous memory mapping: pages are zeroed by the kernel
+ * on the first touch instead of all at once on construction
+ */
+class PoolArena
+{
+public:
+    PoolArena(const std::size_t size, const PoolStorage & storage);
+    PoolArena(const PoolArena &) = delete;
+    PoolArena & operator=(const PoolArena &) = delete;
+    ~PoolArena();
+
+    std::byte * data() const;
+    std::size_t size() const;
+
+private:
+    std::byte * m_data = nullptr;
+    std::size_t m_size = 0;
+};
+
 class PoolAllocator
 {
 public:
-    PoolAllocator(const std::size_t block_size, std::initializer_list<std::size_t> sizes);
+    PoolAllocator(const std::size_t block_size, std::initializer_list<std::size_t> sizes, const PoolStorage & storage = {});
     void * allocate(const std::size_t n);
+    // nullptr instead of std::bad_alloc if the size class of n is full
+    void * try_allocate(const std::size_t n);
+    // smallest free slot of at least n bytes with the alignment, nullptr if there is none
+    void * allocate_at_least(const std::size_t n, const std::size_t alignment);
     void deallocate(const void * ptr);
+    bool owns(const void * ptr) const;
 
 private:
+    // sorts size classes and places their blocks, returns the size of them all
+    std::size_t layout();
+    void * allocate_from(const std::size_t size_class);
+
     const std::size_t m_blocks_count;
     const std::size_t m_block_size;
     std::vector<std::size_t> m_sizes;
-    std::vector<std::byte> m_storage;
+    // blocks start aligned to the alignment of their size class
+    std::vector<std::size_t> m_offsets;
+    PoolArena m_storage;
     std::vector<std::vector<bool>> m_aviable_memory;
 };
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "pool.h"
+
+#include <cstddef>
+#include <memory_resource>
+
+/**
+ * Memory resource taking memory from a PoolAllocator, so that pmr
+ * containers (e.g. std::pmr::string inside a cached element) are kept
+ * in pools too. A request gets the smallest free slot, that fits it,
+ * requests without one go to the upstream resource. Any slot may be
+ * taken, so the pool shouldn't be the one elements are allocated from
+ * (AllocatorWithPool keeps a separate pool for the buffers).
+ */
+class PoolMemoryResource : public std::pmr::memory_resource
+{
+public:
+    PoolMemoryResource(PoolAllocator & pool, std::pmr::memory_resource * upstream = std::pmr::get_default_resource());
+
+private:
+    void * do_allocate(const std::size_t bytes, const std::size_t alignment) override;
+    void do_deallocate(void * ptr, const std::size_t bytes, const std::size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource & other) const noexcept override;
+
+    PoolAllocator & m_pool;
+    std::pmr::memory_resource * m_upstream;
+};
+
+/**
+ * Standard allocator over PoolMemoryResource
+ * for containers, that aren't pmr ones
+ */
+template <class T>
+class PoolStdAllocator
+{
+public:
+    using value_type = T;
+
+    PoolStdAllocator(PoolMemoryResource & resource)
+        : m_resource(&resource)
+    {
+    }
+
+    template <class U>
+    PoolStdAllocator(const PoolStdAllocator<U> & other)
+        : m_resource(other.resource())
+    {
+    }
+
+    T * allocate(const std::size_t n)
+    {
+        return static_cast<T *>(m_resource->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T * ptr, const std::size_t n)
+    {
+        m_resource->deallocate(ptr, n * sizeof(T), alignof(T));
+    }
+
+    PoolMemoryResource * resource() const
+    {
+        return m_resource;
+    }
+
+    template <class U>
+    bool operator==(const PoolStdAllocator<U> & other) const
+    {
+        return m_resource == other.resource();
+    }
+
+    template <class U>
+    bool operator!=(const PoolStdAllocator<U> & other) const
+    {
+        return m_resource != other.resource();
+    }
+
+private:
+    PoolMemoryResource * m_resource;
+};
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "ghost_list.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <optional>
+
+/**
+ * S3-FIFO (Yang et al., SOSP'23): new entries go to a small FIFO queue
+ * taking 10% of the cache, and only those used while there move to the main
+ * queue. The rest are evicted early and remembered in a ghost queue, so that
+ * their next miss inserts them right into the main queue. The main queue
+ * works as a clock with a 2-bit usage counter.
+ * Interface is described in second_chance_policy.h.
+ */
+template <class Entry>
+class S3FifoPolicy
+{
+    struct Node
+    {
+        Entry entry;
+        std::size_t hash;
+        std::uint8_t freq = 0;
+        bool main = false;
+    };
+
+public:
+    using Handle = typename std::list<Node>::iterator;
+
+    static constexpr bool uses_history = true;
+    static constexpr std::uint8_t max_freq = 3;
+
+    S3FifoPolicy(const std::size_t capacity)
+        : m_small_capacity(std::max<std::size_t>(1, capacity / 10))
+        , m_ghost_capacity(capacity > m_small_capacity ? capacity - m_small_capacity : 1)
+    {
+    }
+
+    std::size_t size() const
+    {
+        return m_small.size() + m_main.size();
+    }
+
+    template <class Pred>
+    std::optional<Handle> find(Pred && pred)
+    {
+        for (auto * queue : {&m_small, &m_main}) {
+            for (auto it = queue->begin(); it != queue->end(); ++it) {
+                if (pred(it->entry)) {
+                    return it;
+                }
+            }
+        }
+        return std::nullopt;
+    }
+
+    Entry & hit(const Handle handle)
+    {
+        handle->freq = std::min<std::uint8_t>(handle->freq + 1, max_freq);
+        return handle->entry;
+    }
+
+    void miss(const std::size_t)
+    {
+    }
+
+    template <class Requeue>
+    Entry & victim(const std::size_t, Requeue && requeue)
+    {
+        while (true) {
+            if (!m_small.empty() && (m_small.size() >= m_small_capacity || m_main.empty())) {
+                const auto last = std::prev(m_small.end());
+                if (last->freq == 0) {
+                    m_victim = last;
+                    return last->entry;
+                }
+                last->main = true;
+                requeue(last->entry);
+                m_main.splice(m_main.begin(), m_small, last);
+            }
+            else {
+                const auto last = std::prev(m_main.end());
+                if (last->freq == 0) {
+                    m_victim = last;
+                    return last->entry;
+                }
+                last->freq--;
+                requeue(last->entry);
+                m_main.splice(m_main.begin(), m_main, last);
+            }
+        }
+    }
+
+    void remove_victim()
+    {
+        if (m_victim->main) {
+            m_main.erase(m_victim);
+        }
+        else {
+            m_ghost.push(m_victim->hash);
+            m_ghost.trim(m_ghost_capacity);
+            m_small.erase(m_victim);
+        }
+    }
+
+    Handle insert(const Entry & entry, const std::size_t hash)
+    {
+        if (m_ghost.contains(hash)) {
+            m_ghost.erase(hash);
+            m_main.push_front(Node{entry, hash, 0, true});
+            return m_main.begin();
+        }
+        m_small.push_front(Node{entry, hash});
+        return m_small.begin();
+    }
+
+    Entry erase(const Handle handle)
+    {
+        Entry result = handle->entry;
+        (handle->main ? m_main : m_small).erase(handle);
+        return result;
+    }
+
+    template <class Func>
+    void for_each(Func && func) const
+    {
+        for (const auto * queue : {&m_small, &m_main}) {
+            for (const auto & node : *queue) {
+                func(node.entry, node.freq != 0);
+            }
+        }
+    }
+
+private:
+    const std::size_t m_small_capacity;
+    const std::size_t m_ghost_capacity;
+    std::list<Node> m_small;
+    std::list<Node> m_main;
+    GhostList m_ghost;
+    Handle m_victim;
+};
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <list>
+#include <optional>
+
+/**
+ * Eviction policies are templates over the cache entry and share an interface:
+ *  - Handle identifies resident entry and stays valid until it's evicted
+ *  - find(pred) looks for resident entry satisfying pred
+ *  - hit(handle) registers access to the entry and returns it
+ *  - miss(hash) is called on every miss before evictions
+ *  - victim(hash, requeue) returns the resident entry to be evicted next, passing
+ *    every entry spared on the way to requeue(const Entry &), hash is the one of
+ *    the missed key
+ *  - remove_victim() evicts the entry returned by the last victim() call
+ *  - insert(entry, hash) adds entry, the cache makes room for it beforehand
+ *  - erase(handle) removes the entry without remembering it as evicted
+ *    and returns it
+ *  - for_each(func) calls func(const Entry &, bool) for resident entries,
+ *    the flag shows whether the entry is considered used
+ * uses_history tells if the policy needs key hashes (otherwise they are 0).
+ */
+
+/**
+ * Second chance: FIFO queue, where used elements are requeued
+ * once instead of being evicted
+ */
+template <class Entry>
+class SecondChancePolicy
+{
+    struct Node
+    {
+        Entry entry;
+        bool flag = false;
+    };
+
+public:
+    using Handle = typename std::list<Node>::iterator;
+
+    static constexpr bool uses_history = false;
+
+    SecondChancePolicy(const std::size_t)
+    {
+    }
+
+    std::size_t size() const
+    {
+        return m_queue.size();
+    }
+
+    template <class Pred>
+    std::optional<Handle> find(Pred && pred)
+    {
+        for (auto it = m_queue.begin(); it != m_queue.end(); ++it) {
+            if (pred(it->entry)) {
+                return it;
+            }
+        }
+        return std::nullopt;
+    }
+
+    Entry & hit(const Handle handle)
+    {
+        handle->flag = true;
+        return handle->entry;
+    }
+
+    void miss(const std::size_t)
+    {
+    }
+
+    template <class Requeue>
+    Entry & victim(const std::size_t, Requeue && requeue)
+    {
+        while (true) {
+            const auto last = std::prev(m_queue.end());
+            if (!last->flag) {
+                return last->entry;
+            }
+            last->flag = false;
+            requeue(last->entry);
+            m_queue.splice(m_queue.begin(), m_queue, last);
+        }
+    }
+
+    void remove_victim()
+    {
+        m_queue.pop_back();
+    }
+
+    Handle insert(const Entry & entry, const std::size_t)
+    {
+        m_queue.push_front(Node{entry});
+        return m_queue.begin();
+    }
+
+    Entry erase(const Handle handle)
+    {
+        Entry result = handle->entry;
+        m_queue.erase(handle);
+        return result;
+    }
+
+    template <class Func>
+    void for_each(Func && func) const
+    {
+        for (const auto & node : m_queue) {
+            func(node.entry, node.flag);
+        }
+    }
+
+private:
+    std::list<Node> m_queue;
+};
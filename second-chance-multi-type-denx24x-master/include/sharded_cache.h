@@ -0,0 +1,149 @@
+#pragma once
+
+#include "cache.h"
+#include "spin_lock.h"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Thread-safe cache built from independent caches (shards).
+ * A key always goes to the same shard, chosen by its hash, so threads
+ * working with different shards never contend with each other.
+ * Each shard has its own queue, its own pool and its own lock.
+ */
+template <class Key, class KeyProvider, class Allocator, template <class> class Policy = SecondChancePolicy, class Hash = KeyHash<Key>>
+class ShardedCache
+{
+    using ShardCache = Cache<Key, KeyProvider, Allocator, Policy, Hash>;
+
+    // every shard lives on its own cache lines, so locks don't share them
+    struct alignas(64) Shard
+    {
+        template <class... AllocArgs>
+        Shard(const std::size_t cache_size, const AllocArgs &... alloc_args)
+            : cache(cache_size, alloc_args...)
+        {
+        }
+
+        mutable SpinLock lock;
+        ShardCache cache;
+    };
+
+public:
+    /**
+     * Splits cache_size between shards_count shards as evenly as possible,
+     * alloc_args are used to construct the pool of every shard
+     */
+    template <class... AllocArgs>
+    ShardedCache(const std::size_t cache_size, const std::size_t shards_count, const AllocArgs &... alloc_args)
+    {
+        const std::size_t count = std::max<std::size_t>(1, std::min(shards_count, cache_size));
+        m_shards.reserve(count);
+        for (std::size_t i = 0; i < count; i++) {
+            m_shards.push_back(std::make_unique<Shard>(cache_size / count + (i < cache_size % count ? 1 : 0), alloc_args...));
+        }
+    }
+
+    std::size_t shards_count() const
+    {
+        return m_shards.size();
+    }
+
+    /**
+     * Returns maximum amount of elements the given shard can hold
+     */
+    std::size_t shard_capacity(const std::size_t shard) const
+    {
+        return m_shards[shard]->cache.capacity();
+    }
+
+    /**
+     * Returns maximum amount of elements of every shard
+     */
+    std::vector<std::size_t> capacity_split() const
+    {
+        std::vector<std::size_t> result;
+        result.reserve(m_shards.size());
+        for (const auto & shard : m_shards) {
+            result.push_back(shard->cache.capacity());
+        }
+        return result;
+    }
+
+    std::size_t size() const
+    {
+        std::size_t result = 0;
+        for (const auto & shard : m_shards) {
+            std::lock_guard lock(shard->lock);
+            result += shard->cache.size();
+        }
+        return result;
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    /**
+     * Looks up (or creates) element of type T for the key and calls func(T &)
+     * while its shard is locked. Returned reference can't outlive the lock,
+     * so the element is only accessible inside func, its result is returned.
+     * Key can be of any type Cache::get() accepts.
+     */
+    template <class T, class K, class Func>
+    decltype(auto) get(const K & key, Func && func)
+    {
+        Shard & shard = *m_shards[shard_index(key)];
+        std::lock_guard lock(shard.lock);
+        return std::forward<Func>(func)(shard.cache.template get<T>(key));
+    }
+
+    /**
+     * Returns counters of all shards merged together
+     */
+    CacheStatsSnapshot stats() const
+    {
+        CacheStatsSnapshot result;
+        for (const auto & shard : m_shards) {
+            std::lock_guard lock(shard->lock);
+            result += shard->cache.stats();
+        }
+        return result;
+    }
+
+    std::ostream & print(std::ostream & strm) const
+    {
+        for (std::size_t i = 0; i < m_shards.size(); i++) {
+            std::lock_guard lock(m_shards[i]->lock);
+            strm << "shard " << i << ": " << m_shards[i]->cache;
+        }
+        return strm;
+    }
+
+    friend std::ostream & operator<<(std::ostream & strm, const ShardedCache & cache)
+    {
+        return cache.print(strm);
+    }
+
+private:
+    template <class K>
+    std::size_t shard_index(const K & key) const
+    {
+        if constexpr (std::is_invocable_r_v<std::size_t, const Hash &, const K &>) {
+            return m_hash(key) % m_shards.size();
+        }
+        else {
+            return m_hash(Key(key)) % m_shards.size();
+        }
+    }
+
+    Hash m_hash;
+    std::vector<std::unique_ptr<Shard>> m_shards;
+};
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+
+/**
+ * Writes and reads values in cache snapshots. Trivially copyable types, that
+ * are default constructible, are stored as raw bytes, std::string as size
+ * and characters. Other types can specialize it with the same static write()
+ * and read().
+ */
+template <class T, class = void>
+struct Serializer
+{
+};
+
+template <class T>
+struct Serializer<T, std::enable_if_t<std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>>>
+{
+    static void write(std::ostream & strm, const T & value)
+    {
+        strm.write(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    static T read(std::istream & strm)
+    {
+        char storage[sizeof(T)];
+        strm.read(storage, sizeof(T));
+        T value;
+        std::memcpy(&value, storage, sizeof(T));
+        return value;
+    }
+};
+
+template <>
+struct Serializer<std::string>
+{
+    static void write(std::ostream & strm, const std::string & value)
+    {
+        Serializer<std::uint64_t>::write(strm, value.size());
+        strm.write(value.data(), static_cast<std::streamsize>(value.size()));
+    }
+
+    static std::string read(std::istream & strm)
+    {
+        std::string value(Serializer<std::uint64_t>::read(strm), '\0');
+        strm.read(value.data(), static_cast<std::streamsize>(value.size()));
+        return value;
+    }
+};
+
+template <class T, class = void>
+struct has_serializer : std::false_type
+{
+};
+
+template <class T>
+struct has_serializer<T, std::void_t<decltype(Serializer<T>::write(std::declval<std::ostream &>(), std::declval<const T &>())), decltype(Serializer<T>::read(std::declval<std::istream &>()))>>
+    : std::true_type
+{
+};
+
+template <class T>
+inline constexpr bool has_serializer_v = has_serializer<T>::value;
+
+/**
+ * Checks whether KeyProvider gives back its key with key()
+ */
+template <class KeyProvider, class Key, class = void>
+struct has_key : std::false_type
+{
+};
+
+template <class KeyProvider, class Key>
+struct has_key<KeyProvider, Key, std::void_t<decltype(std::declval<const KeyProvider &>().key())>>
+    : std::is_convertible<decltype(std::declval<const KeyProvider &>().key()), const Key &>
+{
+};
+
+template <class KeyProvider, class Key>
+inline constexpr bool has_key_v = has_key<KeyProvider, Key>::value;
+
+/**
+ * Type of a cached element as it's recorded in snapshots:
+ * name and writer of the payload (null if T has no serializer)
+ */
+template <class Base>
+struct SnapshotType
+{
+    const char * name;
+    void (*write)(std::ostream &, const Base &);
+};
+
+template <class Base, class T>
+void write_snapshot_payload(std::ostream & strm, const Base & value)
+{
+    if constexpr (has_serializer_v<T>) {
+        Serializer<T>::write(strm, static_cast<const T &>(value));
+    }
+    else {
+        static_cast<void>(strm);
+        static_cast<void>(value);
+    }
+}
+
+template <class Base, class T>
+inline const SnapshotType<Base> snapshot_type{typeid(T).name(), has_serializer_v<T> ? &write_snapshot_payload<Base, T> : nullptr};
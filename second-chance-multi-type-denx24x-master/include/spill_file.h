@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+/**
+ * Log of key-value records in a memory mapped file of fixed size, used
+ * as the second tier of a cache. Records are appended, the index in memory
+ * points to the live ones. When the log is full, live records are moved
+ * to its beginning and the oldest of them are dropped if there is still
+ * not enough room. The file is scratch space, it's truncated on open.
+ */
+class SpillFile
+{
+public:
+    SpillFile(const std::string & path, const std::size_t capacity);
+    SpillFile(const SpillFile &) = delete;
+    SpillFile & operator=(const SpillFile &) = delete;
+    ~SpillFile();
+
+    // replaces the record with the same key, records larger than the file are dropped
+    void put(const std::size_t hash, const std::string_view key, const std::string_view value);
+    // value is valid until the next put
+    std::optional<std::string_view> find(const std::size_t hash, const std::string_view key) const;
+    void erase(const std::size_t hash, const std::string_view key);
+
+    std::size_t size() const;
+    std::size_t capacity() const;
+
+private:
+    struct Header
+    {
+        std::uint64_t hash;
+        std::uint32_t key_size;
+        std::uint32_t value_size;
+    };
+
+    using Index = std::unordered_multimap<std::size_t, std::size_t>;
+
+    Header header(const std::size_t offset) const;
+    std::string_view key(const std::size_t offset, const Header & header) const;
+    Index::const_iterator locate(const std::size_t hash, const std::string_view key) const;
+    Index::iterator locate_offset(const std::size_t hash, const std::size_t offset);
+    // makes room for a record of the size
+    void compact(const std::size_t needed);
+
+    int m_fd = -1;
+    std::byte * m_data = nullptr;
+    const std::size_t m_capacity;
+    std::size_t m_end = 0;
+    // size of the records in the index
+    std::size_t m_live_size = 0;
+    // hash to record offset
+    Index m_index;
+};
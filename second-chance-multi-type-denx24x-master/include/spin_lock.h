@@ -0,0 +1,34 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+
+/**
+ * Test-and-test-and-set lock for short critical sections,
+ * satisfies Lockable so it can be used with std::lock_guard
+ */
+class SpinLock
+{
+public:
+    void lock() noexcept
+    {
+        while (m_locked.exchange(true, std::memory_order_acquire)) {
+            while (m_locked.load(std::memory_order_relaxed)) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    bool try_lock() noexcept
+    {
+        return !m_locked.load(std::memory_order_relaxed) && !m_locked.exchange(true, std::memory_order_acquire);
+    }
+
+    void unlock() noexcept
+    {
+        m_locked.store(false, std::memory_order_release);
+    }
+
+private:
+    std::atomic<bool> m_locked{false};
+};
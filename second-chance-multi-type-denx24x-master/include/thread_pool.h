@@ -0,0 +1,33 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Fixed set of worker threads running submitted tasks in FIFO order.
+ * Destructor waits for all the submitted tasks.
+ */
+class ThreadPool
+{
+public:
+    ThreadPool(const std::size_t threads_count);
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool & operator=(const ThreadPool &) = delete;
+    ~ThreadPool();
+
+    void submit(std::function<void()> task);
+
+private:
+    void run();
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::deque<std::function<void()>> m_tasks;
+    bool m_stopped = false;
+    std::vector<std::thread> m_threads;
+};
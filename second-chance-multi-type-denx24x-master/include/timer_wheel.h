@@ -0,0 +1,177 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+
+/**
+ * Hierarchical timer wheel (Varghese, Lauck): timers are kept in slots by
+ * their deadline tick, level 0 has a slot per tick, every next level has
+ * a slot per whole rotation of the previous one. When time reaches a slot
+ * of an upper level, its timers are spread over the lower levels, timers
+ * of the current level 0 slot become due. Deadlines beyond the top level
+ * wait in the overflow list, that is checked on every top level rotation.
+ *
+ * Adding and cancelling a timer takes O(1), advancing time takes O(levels)
+ * per rotation of a non-empty level plus O(1) per timer moved or due.
+ */
+template <class Value>
+class TimerWheel
+{
+    static constexpr std::size_t levels = 4;
+    static constexpr std::size_t slot_bits = 6;
+    static constexpr std::size_t slots = std::size_t{1} << slot_bits;
+
+    struct Timer
+    {
+        Value value;
+        std::uint64_t deadline;
+        // slot the timer is in, overflow_slot or due_slot for the other lists
+        std::size_t slot = 0;
+    };
+
+    using List = std::list<Timer>;
+
+public:
+    using Handle = typename List::iterator;
+
+    std::uint64_t now() const
+    {
+        return m_now;
+    }
+
+    std::uint64_t deadline(const Handle handle) const
+    {
+        return handle->deadline;
+    }
+
+    const Value & value(const Handle handle) const
+    {
+        return handle->value;
+    }
+
+    /**
+     * Adds timer for the deadline tick, past deadlines are due at once
+     */
+    Handle add(const Value & value, const std::uint64_t deadline)
+    {
+        m_overflow.push_front(Timer{value, deadline});
+        const Handle handle = m_overflow.begin();
+        place(m_overflow, handle);
+        return handle;
+    }
+
+    void cancel(const Handle handle)
+    {
+        if (handle->slot < levels * slots) {
+            m_counts[handle->slot / slots]--;
+        }
+        list(handle->slot).erase(handle);
+    }
+
+    /**
+     * Moves time forward to the tick, timers with deadline up to it become due
+     */
+    void advance(const std::uint64_t to)
+    {
+        while (m_now < to) {
+            // levels below the first non-empty one can be skipped entirely
+            std::size_t level = 0;
+            while (level < levels && m_counts[level] == 0) {
+                level++;
+            }
+            const std::uint64_t step = std::uint64_t{1} << (slot_bits * level);
+            const std::uint64_t next = (m_now / step + 1) * step;
+            if (next > to) {
+                m_now = to;
+                return;
+            }
+            m_now = next;
+            tick();
+        }
+    }
+
+    bool has_due() const
+    {
+        return !m_due.empty();
+    }
+
+    /**
+     * Removes the oldest due timer and returns its value
+     */
+    Value pop_due()
+    {
+        Value result = m_due.back().value;
+        m_due.pop_back();
+        return result;
+    }
+
+private:
+    List & list(const std::size_t slot)
+    {
+        if (slot < levels * slots) {
+            return m_slots[slot];
+        }
+        return slot == overflow_slot ? m_overflow : m_due;
+    }
+
+    // moves timer from the list to the slot its deadline belongs to
+    void place(List & from, const Handle handle)
+    {
+        const std::uint64_t deadline = handle->deadline;
+        std::size_t level = 0;
+        while (level < levels && (deadline >> (slot_bits * (level + 1))) != (m_now >> (slot_bits * (level + 1)))) {
+            level++;
+        }
+        if (deadline <= m_now) {
+            handle->slot = due_slot;
+            m_due.splice(m_due.begin(), from, handle);
+        }
+        else if (level == levels) {
+            handle->slot = overflow_slot;
+            m_overflow.splice(m_overflow.begin(), from, handle);
+        }
+        else {
+            handle->slot = level * slots + ((deadline >> (slot_bits * level)) & (slots - 1));
+            m_slots[handle->slot].splice(m_slots[handle->slot].begin(), from, handle);
+            m_counts[level]++;
+        }
+    }
+
+    void cascade(List & from)
+    {
+        List pending;
+        pending.splice(pending.end(), from);
+        while (!pending.empty()) {
+            place(pending, pending.begin());
+        }
+    }
+
+    // handles m_now reaching a new tick
+    void tick()
+    {
+        for (std::size_t level = 0; level < levels; level++) {
+            const std::size_t shift = slot_bits * level;
+            if (level != 0 && (m_now & ((std::uint64_t{1} << shift) - 1)) != 0) {
+                return;
+            }
+            List & slot = m_slots[level * slots + ((m_now >> shift) & (slots - 1))];
+            m_counts[level] -= slot.size();
+            cascade(slot);
+        }
+        if ((m_now & ((std::uint64_t{1} << (slot_bits * levels)) - 1)) == 0) {
+            cascade(m_overflow);
+        }
+    }
+
+    static constexpr std::size_t overflow_slot = levels * slots;
+    static constexpr std::size_t due_slot = levels * slots + 1;
+
+    std::uint64_t m_now = 0;
+    std::array<List, levels * slots> m_slots;
+    std::array<std::size_t, levels> m_counts{};
+    List m_overflow;
+    // the oldest due timer is the last one
+    List m_due;
+};
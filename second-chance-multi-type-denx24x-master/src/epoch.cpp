@@ -0,0 +1,67 @@
+#include "epoch.h"
+
+namespace {
+
+std::size_t current_stripe(const std::size_t stripes_count)
+{
+    static std::atomic<std::size_t> threads_count{0};
+    thread_local const std::size_t thread_id = threads_count.fetch_add(1, std::memory_order_relaxed);
+    return thread_id % stripes_count;
+}
+
+} // anonymous namespace
+
+EpochDomain::Guard::Guard(std::atomic<std::size_t> * readers)
+    : m_readers(readers)
+{
+}
+
+EpochDomain::Guard::Guard(Guard && other) noexcept
+    : m_readers(other.m_readers)
+{
+    other.m_readers = nullptr;
+}
+
+EpochDomain::Guard::~Guard()
+{
+    if (m_readers != nullptr) {
+        m_readers->fetch_sub(1, std::memory_order_release);
+    }
+}
+
+EpochDomain::Guard EpochDomain::pin()
+{
+    Stripe & stripe = m_stripes[current_stripe(stripes_count)];
+    while (true) {
+        const std::size_t epoch = m_epoch.load();
+        std::atomic<std::size_t> & readers = stripe.readers[epoch % 2];
+        readers.fetch_add(1);
+        // the epoch could have moved on before we were counted,
+        // then writer might have missed us and we have to retry
+        if (m_epoch.load() == epoch) {
+            return Guard(&readers);
+        }
+        readers.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+std::size_t EpochDomain::epoch() const
+{
+    return m_epoch.load();
+}
+
+bool EpochDomain::try_advance()
+{
+    std::size_t epoch = m_epoch.load();
+    for (const auto & stripe : m_stripes) {
+        if (stripe.readers[(epoch + 1) % 2].load() != 0) {
+            return false;
+        }
+    }
+    return m_epoch.compare_exchange_strong(epoch, epoch + 1);
+}
+
+bool EpochDomain::can_reclaim(const std::size_t retired) const
+{
+    return epoch() >= retired + 2;
+}
@@ -0,0 +1,79 @@
+#include "frequency_sketch.h"
+
+#include <algorithm>
+
+namespace {
+
+constexpr std::uint64_t seeds[] = {0x9E3779B97F4A7C15, 0xC2B2AE3D27D4EB4F, 0x165667B19E3779F9, 0xD6E8FEB86659FD93};
+
+std::size_t width_for(const std::size_t capacity)
+{
+    std::size_t result = 16;
+    while (result < capacity) {
+        result *= 2;
+    }
+    return result;
+}
+
+} // anonymous namespace
+
+FrequencySketch::FrequencySketch(const std::size_t capacity)
+    : m_width(width_for(capacity))
+    , m_sample_size(10 * m_width)
+    , m_counters(depth * m_width / 2)
+{
+}
+
+std::size_t FrequencySketch::index(const std::size_t hash, const std::size_t row) const
+{
+    std::uint64_t mixed = (hash + row) * seeds[row];
+    mixed ^= mixed >> 32;
+    return row * m_width + (mixed & (m_width - 1));
+}
+
+std::uint8_t FrequencySketch::counter(const std::size_t index) const
+{
+    return (m_counters[index / 2] >> (index % 2 * 4)) & max_frequency;
+}
+
+void FrequencySketch::set_counter(const std::size_t index, const std::uint8_t value)
+{
+    const unsigned shift = index % 2 * 4;
+    std::uint8_t & pair = m_counters[index / 2];
+    pair = static_cast<std::uint8_t>((pair & ~(max_frequency << shift)) | (value << shift));
+}
+
+void FrequencySketch::increment(const std::size_t hash)
+{
+    bool incremented = false;
+    for (std::size_t row = 0; row < depth; row++) {
+        const std::size_t i = index(hash, row);
+        const std::uint8_t value = counter(i);
+        if (value < max_frequency) {
+            set_counter(i, value + 1);
+            incremented = true;
+        }
+    }
+    if (incremented && ++m_increments == m_sample_size) {
+        age();
+    }
+}
+
+std::uint8_t FrequencySketch::frequency(const std::size_t hash) const
+{
+    std::uint8_t result = max_frequency;
+    for (std::size_t row = 0; row < depth; row++) {
+        result = std::min(result, counter(index(hash, row)));
+    }
+    return result;
+}
+
+void FrequencySketch::age()
+{
+    // both halves of a byte are halved at once, the bits shifted
+    // between them are masked out
+    for (auto & pair : m_counters) {
+        pair = (pair >> 1) & 0x77;
+    }
+    m_increments /= 2;
+}
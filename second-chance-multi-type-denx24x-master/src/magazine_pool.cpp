@@ -0,0 +1,196 @@
+#include "magazine_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace {
+
+using Magazine = std::vector<void *>;
+
+} // anonymous namespace
+
+struct MagazinePoolAllocator::Depot
+{
+    struct alignas(64) SizeClass
+    {
+        std::mutex lock;
+        std::vector<Magazine> full;
+        std::vector<Magazine> empty;
+    };
+
+    Depot(const std::size_t block_size_, std::initializer_list<std::size_t> sizes_, const std::size_t magazine_size_)
+        : id(next_id.fetch_add(1, std::memory_order_relaxed))
+        , block_size(block_size_)
+        , magazine_size(std::max<std::size_t>(1, magazine_size_))
+        , sizes(sizes_)
+        , storage(block_size_ * sizes_.size())
+        , classes(sizes_.size())
+    {
+        std::sort(sizes.begin(), sizes.end());
+        for (std::size_t i = 0; i < sizes.size(); i++) {
+            for (std::size_t pos = 0; pos + sizes[i] <= block_size; pos += sizes[i]) {
+                if (classes[i].full.empty() || classes[i].full.back().size() == magazine_size) {
+                    classes[i].full.emplace_back();
+                    classes[i].full.back().reserve(magazine_size);
+                }
+                classes[i].full.back().push_back(&storage[i * block_size + pos]);
+            }
+        }
+    }
+
+    static inline std::atomic<std::size_t> next_id{0};
+
+    const std::size_t id;
+    const std::size_t block_size;
+    const std::size_t magazine_size;
+    std::vector<std::size_t> sizes;
+    std::vector<std::byte> storage;
+    std::vector<SizeClass> classes;
+};
+
+struct MagazinePoolAllocator::ThreadCache
+{
+    struct SizeClass
+    {
+        Magazine loaded;
+        Magazine previous;
+    };
+
+    ThreadCache(const std::shared_ptr<Depot> & depot_)
+        : id(depot_->id)
+        , depot(depot_)
+        , classes(depot_->classes.size())
+    {
+    }
+
+    ThreadCache(const ThreadCache &) = delete;
+    ThreadCache & operator=(const ThreadCache &) = delete;
+
+    // thread is gone, its free slots go back to the depot
+    ~ThreadCache()
+    {
+        const auto alive = depot.lock();
+        if (!alive) {
+            return;
+        }
+        for (std::size_t i = 0; i < classes.size(); i++) {
+            std::lock_guard lock(alive->classes[i].lock);
+            for (Magazine * magazine : {&classes[i].loaded, &classes[i].previous}) {
+                if (!magazine->empty()) {
+                    alive->classes[i].full.push_back(std::move(*magazine));
+                }
+            }
+        }
+    }
+
+    const std::size_t id;
+    const std::weak_ptr<Depot> depot;
+    std::vector<SizeClass> classes;
+};
+
+MagazinePoolAllocator::MagazinePoolAllocator(const std::size_t block_size, std::initializer_list<std::size_t> sizes, const std::size_t magazine_size)
+    : m_depot(std::make_shared<Depot>(block_size, sizes, magazine_size))
+{
+}
+
+MagazinePoolAllocator::ThreadCache & MagazinePoolAllocator::thread_cache() const
+{
+    thread_local std::vector<std::unique_ptr<ThreadCache>> caches;
+    thread_local ThreadCache * last = nullptr;
+    if (last != nullptr && last->id == m_depot->id) {
+        return *last;
+    }
+    auto it = std::find_if(caches.begin(), caches.end(), [this](const auto & cache) {
+        return cache->id == m_depot->id;
+    });
+    if (it == caches.end()) {
+        // caches of destroyed allocators are not needed anymore
+        caches.erase(std::remove_if(caches.begin(), caches.end(), [](const auto & cache) {
+                         return cache->depot.expired();
+                     }),
+                     caches.end());
+        caches.push_back(std::make_unique<ThreadCache>(m_depot));
+        it = std::prev(caches.end());
+    }
+    last = it->get();
+    return *last;
+}
+
+void * MagazinePoolAllocator::allocate(const std::size_t n)
+{
+    if (void * ptr = try_allocate(n)) {
+        return ptr;
+    }
+    throw std::bad_alloc{};
+}
+
+void * MagazinePoolAllocator::try_allocate(const std::size_t n)
+{
+    Depot & depot = *m_depot;
+    ThreadCache & cache = thread_cache();
+    std::size_t start = std::lower_bound(depot.sizes.begin(), depot.sizes.end(), n) - depot.sizes.begin();
+    for (std::size_t i = start; i < depot.sizes.size() && depot.sizes[i] == n; i++) {
+        ThreadCache::SizeClass & current = cache.classes[i];
+        if (current.loaded.empty()) {
+            if (!current.previous.empty()) {
+                std::swap(current.loaded, current.previous);
+            }
+            else {
+                Depot::SizeClass & shared = depot.classes[i];
+                std::lock_guard lock(shared.lock);
+                if (shared.full.empty()) {
+                    continue;
+                }
+                if (current.previous.capacity() != 0) {
+                    shared.empty.push_back(std::move(current.previous));
+                }
+                current.previous = std::move(current.loaded);
+                current.loaded = std::move(shared.full.back());
+                shared.full.pop_back();
+            }
+        }
+        void * result = current.loaded.back();
+        current.loaded.pop_back();
+        return result;
+    }
+    return nullptr;
+}
+
+void MagazinePoolAllocator::deallocate(const void * ptr)
+{
+    Depot & depot = *m_depot;
+    auto b_ptr = static_cast<const std::byte *>(ptr);
+    const auto begin = depot.storage.data();
+    std::less_equal<const std::byte *> cmp;
+    if (depot.storage.empty() || !cmp(begin, b_ptr) || !cmp(b_ptr, &depot.storage.back())) {
+        return;
+    }
+    const std::size_t block = (b_ptr - begin) / depot.block_size;
+    ThreadCache::SizeClass & current = thread_cache().classes[block];
+    if (current.loaded.size() == depot.magazine_size) {
+        if (current.previous.empty()) {
+            std::swap(current.loaded, current.previous);
+        }
+        else {
+            Depot::SizeClass & shared = depot.classes[block];
+            std::unique_lock lock(shared.lock);
+            shared.full.push_back(std::move(current.previous));
+            current.previous = std::move(current.loaded);
+            if (!shared.empty.empty()) {
+                current.loaded = std::move(shared.empty.back());
+                shared.empty.pop_back();
+            }
+            else {
+                lock.unlock();
+                current.loaded = Magazine();
+            }
+        }
+    }
+    if (current.loaded.capacity() == 0) {
+        current.loaded.reserve(depot.magazine_size);
+    }
+    current.loaded.push_back(const_cast<void *>(ptr));
+}
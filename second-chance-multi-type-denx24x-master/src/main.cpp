@@ -2,21 +2,23 @@
 #include "cache.h"
 
 #include <iostream>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 
 namespace {
 
 struct String
 {
-    std::string data;
+    std::pmr::string data;
     bool marked = false;
 
-    String(const std::string & key)
-        : data(key)
+    String(const std::string & key, std::pmr::memory_resource * resource = std::pmr::get_default_resource())
+        : data(key, resource)
     {
     }
 
-    bool operator==(const std::string & other) const
+    bool operator==(std::string_view other) const
     {
         return data == other;
     }
@@ -33,10 +35,11 @@ using TestCache = Cache<std::string, String, AllocatorWithPool>;
 
 int main()
 {
-    TestCache cache(9, 10 * sizeof(String), std::initializer_list<std::size_t>{sizeof(String)});
+    // long lines are kept in a pool too, apart from the elements
+    TestCache cache(9, 10 * sizeof(String), std::initializer_list<std::size_t>{sizeof(String)}, std::initializer_list<std::size_t>{64, 128});
     std::string line;
     while (std::getline(std::cin, line)) {
-        auto & s = cache.get<String>(line);
+        auto & s = cache.emplace<String>(line, line, cache.allocator().resource());
         if (s.marked) {
             std::cout << "known" << std::endl;
         }
@@ -1,40 +1,184 @@
 #include <pool.h>
 
-PoolAllocator::PoolAllocator(const std::size_t block_size, std::initializer_list<std::size_t> sizes)
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <linux/mempolicy.h>
+#include <new>
+#include <string>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <system_error>
+#include <unistd.h>
+
+namespace {
+
+// default huge page size on x86-64 and arm64
+constexpr std::size_t huge_page_size = std::size_t{2} << 20;
+constexpr std::size_t max_alignment = 4096;
+
+std::size_t round_up(const std::size_t value, const std::size_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// size of a type is a multiple of its alignment,
+// so the lowest set bit of a size class fits any type of that size
+std::size_t class_alignment(const std::size_t size)
+{
+    return std::clamp<std::size_t>(size & (~size + 1), 1, max_alignment);
+}
+
+void * map(const std::size_t size, const int flags)
+{
+    void * data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0);
+    return data == MAP_FAILED ? nullptr : data;
+}
+
+void bind(void * data, const std::size_t size, const int node)
+{
+    constexpr std::size_t word_bits = sizeof(unsigned long) * CHAR_BIT;
+    const auto index = static_cast<std::size_t>(node);
+    std::vector<unsigned long> mask(index / word_bits + 1);
+    mask[index / word_bits] |= 1UL << (index % word_bits);
+    // there is no glibc wrapper, libnuma isn't needed just for it
+    if (syscall(SYS_mbind, data, size, MPOL_BIND, mask.data(), mask.size() * word_bits + 1, 0) != 0) {
+        throw std::system_error(errno, std::generic_category(), "can't bind pool to NUMA node " + std::to_string(node));
+    }
+}
+
+} // anonymous namespace
+
+PoolArena::PoolArena(const std::size_t size, const PoolStorage & storage)
+{
+    if (size == 0) {
+        return;
+    }
+    void * data = nullptr;
+    if (storage.pages == PoolStorage::Pages::Huge) {
+        m_size = round_up(size, huge_page_size);
+        data = map(m_size, MAP_HUGETLB);
+    }
+    if (data == nullptr) {
+        m_size = size;
+        data = map(m_size, 0);
+        if (data == nullptr) {
+            throw std::bad_alloc{};
+        }
+        if (storage.pages != PoolStorage::Pages::Regular) {
+            // only a hint, transparent huge pages may be disabled
+            madvise(data, m_size, MADV_HUGEPAGE);
+        }
+    }
+    m_data = static_cast<std::byte *>(data);
+    if (storage.numa_node >= 0) {
+        try {
+            bind(data, m_size, storage.numa_node);
+        }
+        catch (...) {
+            munmap(data, m_size);
+            throw;
+        }
+    }
+}
+
+PoolArena::~PoolArena()
+{
+    if (m_data != nullptr) {
+        munmap(m_data, m_size);
+    }
+}
+
+std::byte * PoolArena::data() const
+{
+    return m_data;
+}
+
+std::size_t PoolArena::size() const
+{
+    return m_size;
+}
+
+std::size_t PoolAllocator::layout()
+{
+    std::sort(m_sizes.begin(), m_sizes.end());
+    std::size_t end = 0;
+    for (const std::size_t size : m_sizes) {
+        m_offsets.push_back(round_up(end, class_alignment(size)));
+        end = m_offsets.back() + m_block_size;
+    }
+    return end;
+}
+
+PoolAllocator::PoolAllocator(const std::size_t block_size, std::initializer_list<std::size_t> sizes, const PoolStorage & storage)
     : m_blocks_count(sizes.size())
     , m_block_size(block_size)
-    , m_storage(block_size * sizes.size())
+    , m_sizes(sizes)
+    , m_storage(layout(), storage)
 {
     m_aviable_memory.resize(m_blocks_count);
-    m_sizes.insert(m_sizes.end(), sizes.begin(), sizes.end());
-    std::sort(m_sizes.begin(), m_sizes.end());
     for (std::size_t i = 0; i < m_blocks_count; i++) {
         m_aviable_memory[i].resize(m_block_size / m_sizes[i], true);
     }
 }
 
 void * PoolAllocator::allocate(const std::size_t n)
+{
+    if (void * ptr = try_allocate(n)) {
+        return ptr;
+    }
+    throw std::bad_alloc{};
+}
+
+void * PoolAllocator::try_allocate(const std::size_t n)
 {
     std::size_t start = std::lower_bound(m_sizes.begin(), m_sizes.end(), n) - m_sizes.begin();
     for (std::size_t i = start; i < m_blocks_count && m_sizes[i] == n; i++) {
-        std::vector<bool> & current = m_aviable_memory[i];
-        std::size_t pos = std::find(current.begin(), current.end(), true) - current.begin();
-        if (pos != current.size()) {
-            current[pos] = false;
-            return &m_storage[i * m_block_size + pos * m_sizes[i]];
+        if (void * ptr = allocate_from(i)) {
+            return ptr;
         }
     }
-    throw std::bad_alloc{};
+    return nullptr;
+}
+
+void * PoolAllocator::allocate_at_least(const std::size_t n, const std::size_t alignment)
+{
+    std::size_t start = std::lower_bound(m_sizes.begin(), m_sizes.end(), n) - m_sizes.begin();
+    for (std::size_t i = start; i < m_blocks_count; i++) {
+        if (class_alignment(m_sizes[i]) % alignment != 0) {
+            continue;
+        }
+        if (void * ptr = allocate_from(i)) {
+            return ptr;
+        }
+    }
+    return nullptr;
+}
+
+void * PoolAllocator::allocate_from(const std::size_t size_class)
+{
+    std::vector<bool> & current = m_aviable_memory[size_class];
+    std::size_t pos = std::find(current.begin(), current.end(), true) - current.begin();
+    if (pos == current.size()) {
+        return nullptr;
+    }
+    current[pos] = false;
+    return m_storage.data() + m_offsets[size_class] + pos * m_sizes[size_class];
 }
 
 void PoolAllocator::deallocate(const void * ptr)
+{
+    if (owns(ptr)) {
+        const std::size_t offset = static_cast<const std::byte *>(ptr) - m_storage.data();
+        const std::size_t block = std::upper_bound(m_offsets.begin(), m_offsets.end(), offset) - m_offsets.begin() - 1;
+        m_aviable_memory[block][(offset - m_offsets[block]) / m_sizes[block]] = true;
+    }
+}
+
+bool PoolAllocator::owns(const void * ptr) const
 {
     auto b_ptr = static_cast<const std::byte *>(ptr);
-    const auto begin = m_storage.data();
+    const std::byte * begin = m_storage.data();
     std::less_equal<const std::byte *> cmp;
-    if (cmp(b_ptr, &m_storage.back()) && cmp(begin, b_ptr)) {
-        const std::size_t offset = b_ptr - begin;
-        const std::size_t block = offset / m_block_size;
-        m_aviable_memory[block][offset % m_block_size / m_sizes[block]] = true;
-    }
+    return m_blocks_count != 0 && cmp(begin, b_ptr) && cmp(b_ptr, begin + m_offsets.back() + m_block_size - 1);
 }
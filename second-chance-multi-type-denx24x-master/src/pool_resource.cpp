@@ -0,0 +1,30 @@
+#include "pool_resource.h"
+
+PoolMemoryResource::PoolMemoryResource(PoolAllocator & pool, std::pmr::memory_resource * upstream)
+    : m_pool(pool)
+    , m_upstream(upstream)
+{
+}
+
+void * PoolMemoryResource::do_allocate(const std::size_t bytes, const std::size_t alignment)
+{
+    if (void * ptr = m_pool.allocate_at_least(bytes, alignment)) {
+        return ptr;
+    }
+    return m_upstream->allocate(bytes, alignment);
+}
+
+void PoolMemoryResource::do_deallocate(void * ptr, const std::size_t bytes, const std::size_t alignment)
+{
+    if (m_pool.owns(ptr)) {
+        m_pool.deallocate(ptr);
+    }
+    else {
+        m_upstream->deallocate(ptr, bytes, alignment);
+    }
+}
+
+bool PoolMemoryResource::do_is_equal(const std::pmr::memory_resource & other) const noexcept
+{
+    return this == &other;
+}
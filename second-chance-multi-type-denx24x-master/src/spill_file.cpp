@@ -0,0 +1,149 @@
+#include "spill_file.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+SpillFile::SpillFile(const std::string & path, const std::size_t capacity)
+    : m_capacity(capacity)
+{
+    m_fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (m_fd < 0) {
+        throw std::runtime_error("can't open " + path);
+    }
+    if (ftruncate(m_fd, static_cast<off_t>(m_capacity)) != 0) {
+        close(m_fd);
+        throw std::runtime_error("can't resize " + path);
+    }
+    if (m_capacity != 0) {
+        void * data = mmap(nullptr, m_capacity, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+        if (data == MAP_FAILED) {
+            close(m_fd);
+            throw std::runtime_error("can't map " + path);
+        }
+        m_data = static_cast<std::byte *>(data);
+    }
+}
+
+SpillFile::~SpillFile()
+{
+    if (m_data != nullptr) {
+        munmap(m_data, m_capacity);
+    }
+    close(m_fd);
+}
+
+void SpillFile::put(const std::size_t hash, const std::string_view key, const std::string_view value)
+{
+    erase(hash, key);
+    const std::size_t size = sizeof(Header) + key.size() + value.size();
+    if (size > m_capacity) {
+        return;
+    }
+    if (m_end + size > m_capacity) {
+        compact(size);
+    }
+    const Header header{hash, static_cast<std::uint32_t>(key.size()), static_cast<std::uint32_t>(value.size())};
+    std::byte * record = m_data + m_end;
+    std::memcpy(record, &header, sizeof(Header));
+    std::memcpy(record + sizeof(Header), key.data(), key.size());
+    std::memcpy(record + sizeof(Header) + key.size(), value.data(), value.size());
+    m_index.emplace(hash, m_end);
+    m_end += size;
+    m_live_size += size;
+}
+
+std::optional<std::string_view> SpillFile::find(const std::size_t hash, const std::string_view key) const
+{
+    const auto it = locate(hash, key);
+    if (it == m_index.end()) {
+        return std::nullopt;
+    }
+    const Header found = header(it->second);
+    const auto * value = reinterpret_cast<const char *>(m_data + it->second + sizeof(Header) + found.key_size);
+    return std::string_view(value, found.value_size);
+}
+
+void SpillFile::erase(const std::size_t hash, const std::string_view key)
+{
+    const auto it = locate(hash, key);
+    if (it != m_index.end()) {
+        const Header found = header(it->second);
+        m_live_size -= sizeof(Header) + found.key_size + found.value_size;
+        m_index.erase(it);
+    }
+}
+
+std::size_t SpillFile::size() const
+{
+    return m_index.size();
+}
+
+std::size_t SpillFile::capacity() const
+{
+    return m_capacity;
+}
+
+auto SpillFile::header(const std::size_t offset) const -> Header
+{
+    // records are packed, so headers may be unaligned
+    Header result;
+    std::memcpy(&result, m_data + offset, sizeof(Header));
+    return result;
+}
+
+std::string_view SpillFile::key(const std::size_t offset, const Header & header) const
+{
+    return std::string_view(reinterpret_cast<const char *>(m_data + offset + sizeof(Header)), header.key_size);
+}
+
+auto SpillFile::locate(const std::size_t hash, const std::string_view key) const -> Index::const_iterator
+{
+    const auto [begin, end] = m_index.equal_range(hash);
+    for (auto it = begin; it != end; ++it) {
+        if (this->key(it->second, header(it->second)) == key) {
+            return it;
+        }
+    }
+    return m_index.end();
+}
+
+auto SpillFile::locate_offset(const std::size_t hash, const std::size_t offset) -> Index::iterator
+{
+    const auto [begin, end] = m_index.equal_range(hash);
+    for (auto it = begin; it != end; ++it) {
+        if (it->second == offset) {
+            return it;
+        }
+    }
+    return m_index.end();
+}
+
+void SpillFile::compact(const std::size_t needed)
+{
+    std::size_t to_drop = m_live_size + needed > m_capacity ? m_live_size + needed - m_capacity : 0;
+    std::size_t written = 0;
+    for (std::size_t offset = 0; offset < m_end;) {
+        const Header current = header(offset);
+        const std::size_t size = sizeof(Header) + current.key_size + current.value_size;
+        const auto indexed = locate_offset(current.hash, offset);
+        if (indexed != m_index.end()) {
+            if (to_drop != 0) {
+                // the oldest live records go first
+                to_drop -= std::min(to_drop, size);
+                m_live_size -= size;
+                m_index.erase(indexed);
+            }
+            else {
+                std::memmove(m_data + written, m_data + offset, size);
+                indexed->second = written;
+                written += size;
+            }
+        }
+        offset += size;
+    }
+    m_end = written;
+}
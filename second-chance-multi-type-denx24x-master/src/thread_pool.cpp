@@ -0,0 +1,50 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(const std::size_t threads_count)
+{
+    const std::size_t count = std::max<std::size_t>(1, threads_count);
+    m_threads.reserve(count);
+    for (std::size_t i = 0; i < count; i++) {
+        m_threads.emplace_back([this] { run(); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopped = true;
+    }
+    m_condition.notify_all();
+    for (auto & thread : m_threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+    }
+    m_condition.notify_one();
+}
+
+void ThreadPool::run()
+{
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock lock(m_mutex);
+            m_condition.wait(lock, [this] { return m_stopped || !m_tasks.empty(); });
+            if (m_tasks.empty()) {
+                return;
+            }
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+        task();
+    }
+}
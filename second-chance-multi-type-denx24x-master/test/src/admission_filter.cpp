@@ -0,0 +1,108 @@
+#include "allocator.h"
+#include "cache.h"
+#include "elements.h"
+#include "frequency_sketch.h"
+
+#include <gtest/gtest.h>
+
+#include <initializer_list>
+#include <string>
+
+namespace {
+
+using TestCache = Cache<std::string, String, AllocatorWithPool>;
+
+} // anonymous namespace
+
+TEST(FrequencySketchTest, counts_increments)
+{
+    FrequencySketch sketch(100);
+    EXPECT_EQ(0, sketch.frequency(42));
+    for (int i = 0; i < 5; ++i) {
+        sketch.increment(42);
+    }
+    sketch.increment(7);
+    EXPECT_EQ(5, sketch.frequency(42));
+    EXPECT_EQ(1, sketch.frequency(7));
+    EXPECT_EQ(0, sketch.frequency(43));
+}
+
+TEST(FrequencySketchTest, counters_saturate)
+{
+    FrequencySketch sketch(100);
+    for (int i = 0; i < 100; ++i) {
+        sketch.increment(42);
+    }
+    EXPECT_EQ(15, sketch.frequency(42));
+}
+
+TEST(FrequencySketchTest, counters_are_halved_with_age)
+{
+    // 16 counters per row, halved after 160 increments
+    FrequencySketch sketch(16);
+    for (int i = 0; i < 10; ++i) {
+        sketch.increment(42);
+    }
+    std::size_t hash = 1000;
+    for (int i = 0; i < 149; ++i) {
+        sketch.increment(hash++);
+    }
+    const auto before = sketch.frequency(42);
+    EXPECT_GE(before, 10);
+    sketch.increment(hash);
+    EXPECT_EQ(before / 2, sketch.frequency(42));
+}
+
+TEST(AdmissionFilterTest, scan_does_not_replace_popular_elements)
+{
+    TestCache cache(4, 10 * sizeof(String), std::initializer_list<std::size_t>{sizeof(String)});
+    cache.set_admission_filter(true);
+    for (int round = 0; round < 5; ++round) {
+        for (const auto key : {"a", "b", "c", "d"}) {
+            cache.get<String>(key);
+        }
+    }
+    for (int i = 0; i < 100; ++i) {
+        const std::string key = "scan" + std::to_string(i);
+        EXPECT_EQ(key, cache.get<String>(key).data);
+    }
+    for (const auto key : {"a", "b", "c", "d"}) {
+        EXPECT_NE(nullptr, cache.find<String>(key)) << key;
+    }
+    EXPECT_EQ(4, cache.size());
+    EXPECT_EQ(100, cache.stats().total.rejections);
+}
+
+TEST(AdmissionFilterTest, rejected_element_is_transient)
+{
+    TestCache cache(1, 10 * sizeof(String), std::initializer_list<std::size_t>{sizeof(String)});
+    cache.set_admission_filter(true);
+    cache.get<String>("a");
+    cache.get<String>("a");
+    auto & rejected = cache.get<String>("b");
+    rejected.marked = true;
+    EXPECT_EQ("b", rejected.data);
+    EXPECT_EQ(nullptr, cache.find<String>("b"));
+    EXPECT_NE(nullptr, cache.find<String>("a"));
+    // b gets in once it is requested more often than a
+    cache.get<String>("b");
+    cache.get<String>("b");
+    auto & admitted = cache.get<String>("b");
+    EXPECT_FALSE(admitted.marked);
+    EXPECT_EQ(&admitted, cache.find<String>("b"));
+    EXPECT_EQ(nullptr, cache.find<String>("a"));
+}
+
+TEST(AdmissionFilterTest, disabled_filter_admits_everything)
+{
+    TestCache cache(2, 10 * sizeof(String), std::initializer_list<std::size_t>{sizeof(String)});
+    cache.set_admission_filter(true);
+    for (int i = 0; i < 3; ++i) {
+        cache.get<String>("a");
+        cache.get<String>("b");
+    }
+    cache.set_admission_filter(false);
+    cache.get<String>("c");
+    EXPECT_NE(nullptr, cache.find<String>("c"));
+    EXPECT_EQ(0, cache.stats().total.rejections);
+}
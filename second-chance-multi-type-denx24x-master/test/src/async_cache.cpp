@@ -0,0 +1,142 @@
+#include "allocator.h"
+#include "async_cache.h"
+#include "thread_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <initializer_list>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+// element, which construction waits for the gate to open
+struct Gated
+{
+    static inline std::atomic<int> built{0};
+    static inline std::shared_future<void> gate;
+
+    std::string data;
+
+    Gated(const std::string & key)
+        : data(key)
+    {
+        built++;
+        gate.wait();
+        if (key == "bad") {
+            throw std::runtime_error("bad key");
+        }
+    }
+
+    Gated(Gated &&) = default;
+
+    bool operator==(std::string_view other) const
+    {
+        return data == other;
+    }
+
+    friend std::ostream & operator<<(std::ostream & strm, const Gated & gated)
+    {
+        return strm << gated.data;
+    }
+};
+
+using TestCache = AsyncCache<std::string, Gated, AllocatorWithPool>;
+
+class AsyncCacheTest : public ::testing::Test
+{
+protected:
+    AsyncCacheTest()
+    {
+        Gated::built = 0;
+        Gated::gate = m_gate.get_future().share();
+    }
+
+    ~AsyncCacheTest() override
+    {
+        open();
+    }
+
+    void open()
+    {
+        if (!m_opened) {
+            m_gate.set_value();
+            m_opened = true;
+        }
+    }
+
+    TestCache cache{4, 3, 10 * sizeof(Gated), std::initializer_list<std::size_t>{sizeof(Gated)}};
+
+private:
+    std::promise<void> m_gate;
+    bool m_opened = false;
+};
+
+template <class T>
+bool ready(const std::future<T> & future)
+{
+    return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+} // anonymous namespace
+
+TEST_F(AsyncCacheTest, single_flight)
+{
+    std::vector<std::future<std::size_t>> sizes;
+    for (int i = 0; i < 10; ++i) {
+        sizes.push_back(cache.get<Gated>(std::string_view("abc"), [](Gated & element) { return element.data.size(); }));
+    }
+    auto other = cache.get<Gated>("xyz", [](Gated & element) { return element.data; });
+    for (const auto & size : sizes) {
+        EXPECT_FALSE(ready(size));
+    }
+    open();
+    for (auto & size : sizes) {
+        EXPECT_EQ(3, size.get());
+    }
+    EXPECT_EQ("xyz", other.get());
+    EXPECT_EQ(2, Gated::built);
+    EXPECT_EQ(2, cache.size());
+}
+
+TEST_F(AsyncCacheTest, hit_is_ready_immediately)
+{
+    open();
+    cache.get<Gated>("abc", [](Gated &) {}).get();
+    auto hit = cache.get<Gated>("abc", [](Gated & element) { return element.data; });
+    EXPECT_TRUE(ready(hit));
+    EXPECT_EQ("abc", hit.get());
+    EXPECT_EQ(1, Gated::built);
+}
+
+TEST_F(AsyncCacheTest, error_reaches_every_waiter)
+{
+    auto first = cache.get<Gated>("bad", [](Gated & element) { return element.data; });
+    auto second = cache.get<Gated>("bad", [](Gated & element) { return element.data; });
+    open();
+    EXPECT_THROW(first.get(), std::runtime_error);
+    EXPECT_THROW(second.get(), std::runtime_error);
+    EXPECT_EQ(1, Gated::built);
+    EXPECT_TRUE(cache.empty());
+    // failed key isn't pending anymore, so it's built again
+    EXPECT_THROW(cache.get<Gated>("bad", [](Gated &) {}).get(), std::runtime_error);
+    EXPECT_EQ(2, Gated::built);
+}
+
+TEST(ThreadPoolTest, runs_all_tasks_before_destruction)
+{
+    std::atomic<int> done{0};
+    {
+        ThreadPool pool(3);
+        for (int i = 0; i < 100; ++i) {
+            pool.submit([&done] { done++; });
+        }
+    }
+    EXPECT_EQ(100, done);
+}
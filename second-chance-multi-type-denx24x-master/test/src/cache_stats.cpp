@@ -0,0 +1,98 @@
+#include "allocator.h"
+#include "cache.h"
+#include "elements.h"
+#include "sharded_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <typeinfo>
+
+namespace {
+
+struct Other : String
+{
+    using String::String;
+
+    int value = 0;
+};
+
+} // anonymous namespace
+
+TEST(CacheStatsTest, ratios)
+{
+    CacheStats stats;
+    EXPECT_EQ(0, stats.hit_ratio());
+    EXPECT_EQ(0, stats.requeues_per_eviction());
+    EXPECT_EQ(0, stats.average_sweep_length());
+    stats.hits = 3;
+    stats.misses = 1;
+    stats.evictions = 2;
+    stats.requeues = 1;
+    stats.sweeps = 4;
+    stats.sweep_length = 10;
+    EXPECT_DOUBLE_EQ(0.75, stats.hit_ratio());
+    EXPECT_DOUBLE_EQ(0.5, stats.requeues_per_eviction());
+    EXPECT_DOUBLE_EQ(2.5, stats.average_sweep_length());
+}
+
+TEST(CacheStatsTest, snapshots_are_merged)
+{
+    CacheStatsSnapshot first;
+    first.total.hits = 1;
+    first.per_type["a"].hits = 1;
+    CacheStatsSnapshot second;
+    second.total.hits = 2;
+    second.total.misses = 5;
+    second.per_type["a"].hits = 2;
+    second.per_type["b"].misses = 5;
+    first += second;
+    EXPECT_EQ(3, first.total.hits);
+    EXPECT_EQ(5, first.total.misses);
+    EXPECT_EQ(3, first.per_type["a"].hits);
+    EXPECT_EQ(5, first.per_type["b"].misses);
+    std::ostringstream strm;
+    strm << first;
+    EXPECT_EQ(0, strm.str().find("total: hits 3 misses 5 hit_ratio 0.375"));
+}
+
+TEST(CacheStatsTest, cache_counters)
+{
+    Cache<std::string, String, AllocatorWithPool> cache(3, 10 * sizeof(Other), std::initializer_list<std::size_t>{sizeof(String), sizeof(Other)});
+    EXPECT_EQ(0, cache.stats().total.misses);
+    for (const auto * key : {"a", "b", "a", "c", "d", "e", "a", "b"}) {
+        cache.get<String>(key);
+    }
+    cache.get<Other>("x");
+    cache.get<Other>("y");
+    const auto stats = cache.stats();
+    EXPECT_EQ(2, stats.total.hits);
+    EXPECT_EQ(8, stats.total.misses);
+    EXPECT_EQ(5, stats.total.evictions);
+    EXPECT_EQ(2, stats.total.requeues);
+    EXPECT_EQ(5, stats.total.sweeps);
+    EXPECT_EQ(7, stats.total.sweep_length);
+    ASSERT_EQ(2, stats.per_type.size());
+    const CacheStats & strings = stats.per_type.at(typeid(String).name());
+    EXPECT_EQ(2, strings.hits);
+    EXPECT_EQ(6, strings.misses);
+    // evictions are counted for the type of the victim
+    EXPECT_EQ(5, strings.evictions);
+    const CacheStats & others = stats.per_type.at(typeid(Other).name());
+    EXPECT_EQ(0, others.hits);
+    EXPECT_EQ(2, others.misses);
+    EXPECT_EQ(0, others.evictions);
+}
+
+TEST(CacheStatsTest, sharded_cache_counters)
+{
+    ShardedCache<std::string, String, AllocatorWithPool> cache(4, 2, 10 * sizeof(String), std::initializer_list<std::size_t>{sizeof(String)});
+    for (const auto * key : {"a", "b", "a", "c", "d", "e", "a", "b"}) {
+        cache.get<String>(std::string(key), [](String &) {});
+    }
+    const auto stats = cache.stats();
+    EXPECT_EQ(8, stats.total.hits + stats.total.misses);
+    EXPECT_EQ(stats.total.misses - cache.size(), stats.total.evictions);
+    EXPECT_EQ(1, stats.per_type.size());
+}
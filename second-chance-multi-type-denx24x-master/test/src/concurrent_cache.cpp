@@ -0,0 +1,129 @@
+#include "allocator.h"
+#include "concurrent_cache.h"
+#include "elements.h"
+#include "epoch.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using TestCache = ConcurrentCache<std::string, String, AllocatorWithPool>;
+
+std::string to_string(const TestCache & cache)
+{
+    std::ostringstream strm;
+    strm << cache;
+    return strm.str();
+}
+
+} // anonymous namespace
+
+TEST(EpochTest, pinned_reader_blocks_reclamation)
+{
+    EpochDomain domain;
+    std::optional<EpochDomain::Guard> guard;
+    guard.emplace(domain.pin());
+    EXPECT_EQ(0, domain.epoch());
+    EXPECT_TRUE(domain.try_advance());
+    EXPECT_FALSE(domain.try_advance());
+    EXPECT_FALSE(domain.can_reclaim(0));
+    guard.reset();
+    EXPECT_TRUE(domain.try_advance());
+    EXPECT_EQ(2, domain.epoch());
+    EXPECT_TRUE(domain.can_reclaim(0));
+    EXPECT_FALSE(domain.can_reclaim(1));
+}
+
+TEST(EpochTest, moved_guard_unpins_once)
+{
+    EpochDomain domain;
+    {
+        auto guard = domain.pin();
+        auto moved = std::move(guard);
+        EXPECT_TRUE(domain.try_advance());
+        EXPECT_FALSE(domain.try_advance());
+    }
+    EXPECT_TRUE(domain.try_advance());
+    EXPECT_TRUE(domain.try_advance());
+    EXPECT_EQ(3, domain.epoch());
+}
+
+TEST(ConcurrentCacheTest, second_chance_order)
+{
+    TestCache cache(3, 10 * sizeof(String), std::initializer_list<std::size_t>{sizeof(String)});
+    EXPECT_EQ("<empty>\n", to_string(cache));
+    for (const auto * key : {"a", "b", "a", "c", "d", "e"}) {
+        cache.get<String>(std::string(key), [](String &) {});
+    }
+    EXPECT_EQ("(e 0) (d 0) (a 0)\n", to_string(cache));
+    EXPECT_EQ(3, cache.size());
+    EXPECT_EQ(3, cache.capacity());
+}
+
+TEST(ConcurrentCacheTest, lookup_by_string_view)
+{
+    TestCache cache(3, 10 * sizeof(String), std::initializer_list<std::size_t>{sizeof(String)});
+    cache.get<String>(std::string_view("abc"), [](String & str) {
+        str.marked = true;
+    });
+    EXPECT_TRUE(cache.get<String>(std::string("abc"), [](String & str) {
+        return str.marked;
+    }));
+    EXPECT_EQ(1, cache.size());
+}
+
+TEST(ConcurrentCacheTest, concurrent_get)
+{
+    TestCache cache(16, 64 * sizeof(String), std::initializer_list<std::size_t>{sizeof(String)});
+    std::vector<std::thread> threads;
+    std::vector<std::size_t> mismatches(4);
+    for (std::size_t t = 0; t < 4; t++) {
+        threads.emplace_back([&cache, &mismatches, t] {
+            for (std::size_t i = 0; i < 50000; i++) {
+                const std::string key = std::to_string((i * 7 + t) % (t == 0 ? 40 : 20));
+                if (!cache.get<String>(key, [&key](String & str) { return str.data == key; })) {
+                    mismatches[t]++;
+                }
+            }
+        });
+    }
+    for (auto & thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ((std::vector<std::size_t>(4)), mismatches);
+    EXPECT_EQ(16, cache.size());
+}
+
+TEST(ConcurrentCacheTest, element_outlives_its_eviction)
+{
+    TestCache cache(4, 512 * sizeof(String), std::initializer_list<std::size_t>{sizeof(String)});
+    std::atomic<bool> reading{false};
+    std::atomic<bool> evicted{false};
+    std::thread reader([&] {
+        cache.get<String>(std::string("kept"), [&](String & str) {
+            reading = true;
+            while (!evicted) {
+                std::this_thread::yield();
+            }
+            // other threads have evicted the element, but it's not destroyed yet
+            EXPECT_EQ("kept", str.data);
+        });
+    });
+    while (!reading) {
+        std::this_thread::yield();
+    }
+    for (int i = 0; i < 200; i++) {
+        cache.get<String>(std::to_string(i), [](String &) {});
+    }
+    EXPECT_EQ(std::string::npos, to_string(cache).find("kept"));
+    evicted = true;
+    reader.join();
+    EXPECT_EQ(4, cache.size());
+}
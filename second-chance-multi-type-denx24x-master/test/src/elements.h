@@ -0,0 +1,36 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <string_view>
+
+/**
+ * KeyProvider of the tested caches: string element, that knows its key
+ */
+struct String
+{
+    std::string data;
+    bool marked = false;
+
+    String(const std::string & key)
+        : data(key)
+    {
+    }
+
+    virtual ~String() = default;
+
+    const std::string & key() const
+    {
+        return data;
+    }
+
+    bool operator==(std::string_view other) const
+    {
+        return data == other;
+    }
+
+    friend std::ostream & operator<<(std::ostream & strm, const String & str)
+    {
+        return strm << str.data;
+    }
+};
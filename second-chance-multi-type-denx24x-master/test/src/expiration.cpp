@@ -0,0 +1,161 @@
+#include "allocator.h"
+#include "arc_policy.h"
+#include "cache.h"
+#include "clock_pro_policy.h"
+#include "elements.h"
+#include "s3fifo_policy.h"
+#include "timer_wheel.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <initializer_list>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+std::set<int> pop_all(TimerWheel<int> & wheel)
+{
+    std::set<int> result;
+    while (wheel.has_due()) {
+        result.insert(wheel.pop_due());
+    }
+    return result;
+}
+
+template <template <class> class P>
+struct PolicyParam
+{
+    using TestCache = Cache<std::string, String, AllocatorWithPool, P>;
+};
+
+template <class Param>
+class CacheTtlTest : public ::testing::Test
+{
+protected:
+    typename Param::TestCache cache{5, 5 * sizeof(String), std::initializer_list<std::size_t>{sizeof(String)}};
+};
+
+using Policies = ::testing::Types<PolicyParam<SecondChancePolicy>, PolicyParam<S3FifoPolicy>, PolicyParam<ArcPolicy>, PolicyParam<ClockProPolicy>>;
+
+} // anonymous namespace
+
+TEST(TimerWheelTest, deadlines)
+{
+    TimerWheel<int> wheel;
+    wheel.add(1, 10);
+    wheel.add(2, 100);
+    const auto cancelled = wheel.add(3, 100);
+    wheel.add(4, std::uint64_t{1} << 40);
+    EXPECT_EQ(100, wheel.deadline(cancelled));
+    EXPECT_EQ(3, wheel.value(cancelled));
+    wheel.cancel(cancelled);
+    wheel.advance(9);
+    EXPECT_FALSE(wheel.has_due());
+    wheel.advance(10);
+    EXPECT_EQ(std::set<int>{1}, pop_all(wheel));
+    // past deadline is due at once
+    wheel.add(5, 3);
+    EXPECT_EQ(std::set<int>{5}, pop_all(wheel));
+    wheel.advance(1000);
+    EXPECT_EQ(std::set<int>{2}, pop_all(wheel));
+    EXPECT_EQ(1000, wheel.now());
+    wheel.advance(std::uint64_t{1} << 40);
+    EXPECT_EQ(std::set<int>{4}, pop_all(wheel));
+}
+
+TEST(TimerWheelTest, matches_ordered_reference)
+{
+    std::mt19937_64 random(1);
+    TimerWheel<int> wheel;
+    std::multimap<std::uint64_t, int> reference;
+    std::map<int, std::pair<TimerWheel<int>::Handle, std::multimap<std::uint64_t, int>::iterator>> pending;
+    std::uint64_t now = 0;
+    int id = 0;
+    for (int step = 0; step < 50000; ++step) {
+        const auto operation = random() % 10;
+        if (operation < 5) {
+            std::uint64_t deadline = now;
+            switch (random() % 4) {
+            case 0: deadline += random() % 70; break;
+            case 1: deadline += random() % 5000; break;
+            case 2: deadline += random() % (std::uint64_t{1} << 26); break;
+            default: deadline += random() % (std::uint64_t{1} << 30);
+            }
+            if (random() % 20 == 0) {
+                deadline = now > 5 ? now - 5 : 0;
+            }
+            pending.emplace(id, std::make_pair(wheel.add(id, deadline), reference.emplace(deadline, id)));
+            id++;
+        }
+        else if (operation < 7) {
+            if (pending.empty()) {
+                continue;
+            }
+            const auto it = pending.lower_bound(static_cast<int>(random() % static_cast<std::uint64_t>(id)));
+            if (it == pending.end()) {
+                continue;
+            }
+            ASSERT_EQ(it->first, wheel.value(it->second.first));
+            wheel.cancel(it->second.first);
+            reference.erase(it->second.second);
+            pending.erase(it);
+        }
+        else {
+            switch (random() % 3) {
+            case 0: now += random() % 3; break;
+            case 1: now += random() % 300; break;
+            default: now += random() % (std::uint64_t{1} << 27);
+            }
+            wheel.advance(now);
+            std::set<int> expected;
+            while (!reference.empty() && reference.begin()->first <= now) {
+                expected.insert(reference.begin()->second);
+                pending.erase(reference.begin()->second);
+                reference.erase(reference.begin());
+            }
+            ASSERT_EQ(expected, pop_all(wheel)) << "step " << step;
+        }
+    }
+}
+
+TYPED_TEST_SUITE(CacheTtlTest, Policies);
+
+TYPED_TEST(CacheTtlTest, expired_elements_go_first)
+{
+    auto & cache = this->cache;
+    cache.set_default_ttl(50ms);
+    for (int i = 0; i < 5; ++i) {
+        cache.template get<String>("a" + std::to_string(i));
+    }
+    EXPECT_TRUE(cache.expire_after(std::string("a0"), 0ms));
+    EXPECT_TRUE(cache.expire_after(std::string("a1"), 1h));
+    EXPECT_FALSE(cache.expire_after(std::string("zz"), 1ms));
+    std::this_thread::sleep_for(100ms);
+    // lookup removes the expired element
+    EXPECT_EQ(nullptr, cache.template find<String>("a2"));
+    EXPECT_EQ(4, cache.size());
+    EXPECT_FALSE(cache.expire_after(std::string("a3"), 1h));
+    EXPECT_EQ(3, cache.size());
+    // b2 needs room, a4 has expired, so it goes instead of a victim
+    cache.set_default_ttl(0ms);
+    for (const auto key : {"b0", "b1", "b2"}) {
+        cache.template get<String>(key);
+    }
+    EXPECT_EQ(5, cache.size());
+    EXPECT_NE(nullptr, cache.template find<String>("a0"));
+    EXPECT_NE(nullptr, cache.template find<String>("a1"));
+    EXPECT_EQ(nullptr, cache.template find<String>("a4"));
+    const auto stats = cache.stats().total;
+    EXPECT_EQ(3, stats.expirations);
+    EXPECT_EQ(0, stats.evictions);
+}
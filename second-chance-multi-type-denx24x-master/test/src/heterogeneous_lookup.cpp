@@ -0,0 +1,147 @@
+#include "allocator.h"
+#include "cache.h"
+#include "elements.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+namespace {
+
+// key, that counts how many times it was built
+struct Name
+{
+    static inline std::size_t built = 0;
+
+    std::string value;
+
+    Name(std::string_view name)
+        : value(name)
+    {
+        built++;
+    }
+};
+
+struct NameHash
+{
+    std::size_t operator()(std::string_view name) const
+    {
+        return std::hash<std::string_view>{}(name);
+    }
+
+    std::size_t operator()(const Name & name) const
+    {
+        return (*this)(name.value);
+    }
+};
+
+struct Named
+{
+    std::string value;
+
+    Named(const Name & name)
+        : value(name.value)
+    {
+    }
+
+    bool operator==(std::string_view other) const
+    {
+        return value == other;
+    }
+
+    bool operator==(const Name & other) const
+    {
+        return value == other.value;
+    }
+
+    friend std::ostream & operator<<(std::ostream & strm, const Named & named)
+    {
+        return strm << named.value;
+    }
+};
+
+// key without hash, elements are compared to it one by one
+struct Opaque
+{
+    int value;
+};
+
+struct Convertible
+{
+    int value;
+
+    operator Opaque() const
+    {
+        return {value};
+    }
+};
+
+struct Numbered
+{
+    int value;
+
+    Numbered(const Opaque & key)
+        : value(key.value)
+    {
+    }
+
+    bool operator==(const Opaque & other) const
+    {
+        return value == other.value;
+    }
+
+    friend std::ostream & operator<<(std::ostream & strm, const Numbered & numbered)
+    {
+        return strm << numbered.value;
+    }
+};
+
+} // anonymous namespace
+
+TEST(HeterogeneousLookupTest, string_like_keys_find_same_element)
+{
+    Cache<std::string, String, AllocatorWithPool> cache(3, 10 * sizeof(String), std::initializer_list<std::size_t>{sizeof(String)});
+    const std::string_view view = "abc";
+    auto & element = cache.get<String>(view);
+    EXPECT_EQ(&element, &cache.get<String>(std::string("abc")));
+    EXPECT_EQ(&element, &cache.get<String>("abc"));
+    EXPECT_EQ(&element, cache.find<String>(std::string_view("abc")));
+    EXPECT_EQ(nullptr, cache.find<String>("ab"));
+    EXPECT_EQ(1, cache.size());
+}
+
+TEST(HeterogeneousLookupTest, hit_does_not_build_key)
+{
+    Cache<Name, Named, AllocatorWithPool, SecondChancePolicy, NameHash> cache(2, 10 * sizeof(Named), std::initializer_list<std::size_t>{sizeof(Named)});
+    Name::built = 0;
+    auto & element = cache.get<Named>(std::string_view("abc"));
+    // only the element is built from the key on miss
+    EXPECT_EQ(1, Name::built);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(&element, &cache.get<Named>(std::string_view("abc")));
+        EXPECT_EQ(&element, cache.find<Named>(std::string_view("abc")));
+    }
+    EXPECT_EQ(nullptr, cache.find<Named>(std::string_view("abd")));
+    EXPECT_EQ(1, Name::built);
+}
+
+TEST(HeterogeneousLookupTest, key_without_hash)
+{
+    Cache<Opaque, Numbered, AllocatorWithPool> cache(2, 10 * sizeof(Numbered), std::initializer_list<std::size_t>{sizeof(Numbered)});
+    auto & first = cache.get<Numbered>(Opaque{1});
+    EXPECT_EQ(&first, &cache.get<Numbered>(Convertible{1}));
+    cache.get<Numbered>(Convertible{2});
+    cache.get<Numbered>({3});
+    EXPECT_EQ(2, cache.size());
+    EXPECT_EQ(nullptr, cache.find<Numbered>(Convertible{2}));
+    std::ostringstream strm;
+    strm << cache;
+    // 1 was used, so 2 is evicted for 3 instead
+    EXPECT_EQ("(3 0) (1 0)\n", strm.str());
+}
@@ -0,0 +1,125 @@
+#include "allocator.h"
+#include "concurrent_cache.h"
+#include "elements.h"
+#include "magazine_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <new>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// allocates until the pool is exhausted
+std::vector<void *> allocate_all(MagazinePoolAllocator & pool, const std::size_t size)
+{
+    std::vector<void *> result;
+    while (void * ptr = pool.try_allocate(size)) {
+        result.push_back(ptr);
+    }
+    return result;
+}
+
+} // anonymous namespace
+
+TEST(MagazinePoolTest, slots_are_distinct)
+{
+    MagazinePoolAllocator pool(100 * sizeof(int), {sizeof(int)}, 4);
+    const auto slots = allocate_all(pool, sizeof(int));
+    EXPECT_EQ(100, slots.size());
+    EXPECT_EQ(100, std::set<void *>(slots.begin(), slots.end()).size());
+    EXPECT_THROW(pool.allocate(sizeof(int)), std::bad_alloc);
+    EXPECT_THROW(pool.allocate(sizeof(double) * 2), std::bad_alloc);
+    pool.deallocate(slots[42]);
+    EXPECT_EQ(slots[42], pool.allocate(sizeof(int)));
+}
+
+TEST(MagazinePoolTest, size_classes_are_separate)
+{
+    MagazinePoolAllocator pool(64, {8, 16}, 2);
+    EXPECT_EQ(8, allocate_all(pool, 8).size());
+    EXPECT_EQ(4, allocate_all(pool, 16).size());
+}
+
+TEST(MagazinePoolTest, foreign_pointer_is_ignored)
+{
+    MagazinePoolAllocator pool(4 * sizeof(int), {sizeof(int)}, 2);
+    int local = 0;
+    pool.deallocate(&local);
+    EXPECT_EQ(4, allocate_all(pool, sizeof(int)).size());
+}
+
+TEST(MagazinePoolTest, pools_on_one_thread_are_apart)
+{
+    MagazinePoolAllocator first(4 * sizeof(int), {sizeof(int)}, 2);
+    MagazinePoolAllocator second(4 * sizeof(int), {sizeof(int)}, 2);
+    void * ptr = first.allocate(sizeof(int));
+    first.deallocate(ptr);
+    const auto slots = allocate_all(second, sizeof(int));
+    EXPECT_EQ(4, slots.size());
+    EXPECT_EQ(0, std::count(slots.begin(), slots.end(), ptr));
+}
+
+TEST(MagazinePoolTest, slots_freed_by_other_threads_return)
+{
+    AllocatorWithMagazines alloc(100 * sizeof(int), {sizeof(int)}, 4);
+    std::vector<std::vector<int *>> kept(4);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < 4; t++) {
+        threads.emplace_back([&alloc, &kept, t] {
+            for (int round = 0; round < 1000; round++) {
+                std::vector<int *> values;
+                for (int i = 0; i < 10; i++) {
+                    values.push_back(alloc.create<int>(i));
+                }
+                for (int * value : values) {
+                    alloc.destroy<int>(value);
+                }
+            }
+            for (int i = 0; i < 5; i++) {
+                kept[t].push_back(alloc.create<int>(static_cast<int>(t)));
+            }
+        });
+    }
+    for (auto & thread : threads) {
+        thread.join();
+    }
+    for (std::size_t t = 0; t < 4; t++) {
+        for (int * value : kept[t]) {
+            EXPECT_EQ(static_cast<int>(t), *value);
+            alloc.destroy<int>(value);
+        }
+    }
+    // magazines of the finished threads went back to the depot
+    std::size_t count = 0;
+    while (alloc.try_create<int>(0) != nullptr) {
+        count++;
+    }
+    EXPECT_EQ(100, count);
+}
+
+TEST(MagazinePoolTest, concurrent_cache)
+{
+    ConcurrentCache<std::string, String, AllocatorWithMagazines> cache(16, 64 * sizeof(String), std::initializer_list<std::size_t>{sizeof(String)});
+    std::vector<std::thread> threads;
+    std::vector<std::size_t> mismatches(4);
+    for (std::size_t t = 0; t < 4; t++) {
+        threads.emplace_back([&cache, &mismatches, t] {
+            for (std::size_t i = 0; i < 20000; i++) {
+                const std::string key = std::to_string((i * 7 + t) % (t == 0 ? 40 : 20));
+                if (!cache.get<String>(key, [&key](String & str) { return str.data == key; })) {
+                    mismatches[t]++;
+                }
+            }
+        });
+    }
+    for (auto & thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ((std::vector<std::size_t>(4)), mismatches);
+    EXPECT_EQ(16, cache.size());
+}
@@ -0,0 +1,149 @@
+#include "allocator.h"
+#include "cache.h"
+#include "elements.h"
+#include "memory_usage.h"
+
+#include <gtest/gtest.h>
+
+#include <initializer_list>
+#include <new>
+#include <sstream>
+#include <string>
+#include <utility>
+
+namespace {
+
+struct Owning : String
+{
+    using String::String;
+
+    std::string payload = std::string(1000, 'x');
+
+    std::size_t memory_usage() const
+    {
+        return payload.capacity();
+    }
+};
+
+struct Padded : String
+{
+    using String::String;
+
+    char pad[64] = {};
+};
+
+// takes its argument over
+struct Sink
+{
+    std::string data;
+
+    Sink(std::string value)
+        : data(std::move(value))
+    {
+    }
+};
+
+static_assert(!has_memory_usage_v<String> && has_memory_usage_v<Owning>);
+
+template <class C>
+std::string print(const C & cache)
+{
+    std::ostringstream strm;
+    strm << cache;
+    return strm.str();
+}
+
+} // anonymous namespace
+
+TEST(MemoryLimitTest, element_memory_usage)
+{
+    const String plain("a");
+    const Owning owning("b");
+    EXPECT_EQ(sizeof(String), element_memory_usage(plain));
+    EXPECT_EQ(sizeof(Owning) + owning.payload.capacity(), element_memory_usage(owning));
+}
+
+TEST(MemoryLimitTest, owned_memory_is_bounded)
+{
+    Cache<std::string, String, AllocatorWithPool> cache(100, 100 * sizeof(Owning), std::initializer_list<std::size_t>{sizeof(String), sizeof(Owning)});
+    const std::size_t limit = 10 * sizeof(String) + 1200;
+    cache.set_memory_limit(limit);
+    EXPECT_EQ(limit, cache.memory_limit());
+    for (int i = 0; i < 20; ++i) {
+        cache.get<String>("s" + std::to_string(i));
+    }
+    EXPECT_EQ(20, cache.size());
+    EXPECT_EQ(20 * sizeof(String), cache.memory_usage());
+
+    const std::size_t owning_usage = element_memory_usage(cache.get<Owning>("big"));
+    EXPECT_LE(cache.memory_usage(), limit);
+    EXPECT_EQ(owning_usage + (cache.size() - 1) * sizeof(String), cache.memory_usage());
+    EXPECT_NE(nullptr, cache.find<String>("s19"));
+    EXPECT_EQ(nullptr, cache.find<String>("s0"));
+
+    cache.get<Owning>("big2");
+    EXPECT_LE(cache.memory_usage(), limit);
+    EXPECT_EQ(nullptr, cache.find<Owning>("big"));
+    EXPECT_NE(nullptr, cache.find<Owning>("big2"));
+}
+
+TEST(MemoryLimitTest, element_over_limit_is_cached_alone)
+{
+    Cache<std::string, String, AllocatorWithPool> cache(10, 10 * sizeof(String), std::initializer_list<std::size_t>{sizeof(String)});
+    cache.get<String>("a");
+    cache.get<String>("b");
+    cache.set_memory_limit(1);
+    cache.get<String>("c");
+    EXPECT_EQ("(c 0)\n", print(cache));
+    EXPECT_EQ(sizeof(String), cache.memory_usage());
+}
+
+TEST(MemoryLimitTest, full_size_class_evicts)
+{
+    // two slots for each size class
+    Cache<std::string, String, AllocatorWithPool> cache(10, 2 * sizeof(Padded), std::initializer_list<std::size_t>{sizeof(String), sizeof(Padded)});
+    for (const auto key : {"s1", "s2", "s3"}) {
+        cache.get<String>(key);
+    }
+    for (const auto key : {"b1", "b2", "b3"}) {
+        cache.get<Padded>(key);
+    }
+    // victims are taken in policy order until a slot of Padded is freed
+    EXPECT_EQ("(b3 0) (b2 0)\n", print(cache));
+}
+
+TEST(MemoryLimitTest, full_magazine_size_class_evicts)
+{
+    Cache<std::string, String, AllocatorWithMagazines> cache(10, 2 * sizeof(Padded), std::initializer_list<std::size_t>{sizeof(String), sizeof(Padded)}, 1);
+    cache.get<String>("s1");
+    for (const auto key : {"b1", "b2", "b3"}) {
+        cache.get<Padded>(key);
+    }
+    EXPECT_EQ("(b3 0) (b2 0)\n", print(cache));
+}
+
+TEST(MemoryLimitTest, no_slots_at_all)
+{
+    Cache<std::string, String, AllocatorWithPool> cache(10, 0, std::initializer_list<std::size_t>{});
+    EXPECT_THROW(cache.get<String>("a"), std::bad_alloc);
+    EXPECT_TRUE(cache.empty());
+}
+
+TEST(MemoryLimitTest, try_create_leaves_arguments)
+{
+    AllocatorWithPool alloc(sizeof(Sink), {sizeof(Sink)});
+    std::string value = "a long enough value to be kept on the heap";
+    Sink * first = alloc.try_create<Sink>(std::move(value));
+    ASSERT_NE(nullptr, first);
+    EXPECT_EQ("a long enough value to be kept on the heap", first->data);
+    value = "another long enough value to be kept on the heap";
+    EXPECT_EQ(nullptr, alloc.try_create<Sink>(std::move(value)));
+    EXPECT_EQ("another long enough value to be kept on the heap", value);
+    EXPECT_THROW(alloc.create<Sink>(value), std::bad_alloc);
+    alloc.destroy<Sink>(first);
+    Sink * second = alloc.try_create<Sink>(std::move(value));
+    ASSERT_NE(nullptr, second);
+    EXPECT_EQ(first, second);
+    EXPECT_EQ("another long enough value to be kept on the heap", second->data);
+    alloc.destroy<Sink>(second);
+}
@@ -0,0 +1,99 @@
+#include "allocator.h"
+#include "arc_policy.h"
+#include "cache.h"
+#include "clock_pro_policy.h"
+#include "elements.h"
+#include "s3fifo_policy.h"
+
+#include <gtest/gtest.h>
+
+#include <initializer_list>
+#include <sstream>
+#include <string>
+
+namespace {
+
+template <template <class> class P, bool ScanResistant>
+struct PolicyParam
+{
+    using TestCache = Cache<std::string, String, AllocatorWithPool, P>;
+
+    static constexpr bool scan_resistant = ScanResistant;
+};
+
+template <class Param>
+class PolicyTest : public ::testing::Test
+{
+protected:
+    typename Param::TestCache cache{8, 64 * sizeof(String), std::initializer_list<std::size_t>{sizeof(String)}};
+};
+
+using Policies = ::testing::Types<PolicyParam<SecondChancePolicy, false>, PolicyParam<S3FifoPolicy, true>, PolicyParam<ArcPolicy, true>, PolicyParam<ClockProPolicy, true>>;
+
+std::string number(const std::size_t i)
+{
+    return "k" + std::to_string(i);
+}
+
+} // anonymous namespace
+
+TYPED_TEST_SUITE(PolicyTest, Policies);
+
+TYPED_TEST(PolicyTest, hit_returns_resident_element)
+{
+    auto & cache = this->cache;
+    auto & first = cache.template get<String>("a");
+    first.marked = true;
+    EXPECT_EQ(&first, &cache.template get<String>("a"));
+    EXPECT_EQ(&first, cache.template find<String>("a"));
+    EXPECT_EQ(nullptr, cache.template find<String>("b"));
+    EXPECT_EQ(1, cache.size());
+}
+
+TYPED_TEST(PolicyTest, size_is_bounded)
+{
+    auto & cache = this->cache;
+    for (std::size_t i = 0; i < 1000; ++i) {
+        const std::string key = number((i * 7919) % 37);
+        EXPECT_EQ(key, cache.template get<String>(key).data);
+        EXPECT_LE(cache.size(), cache.capacity());
+    }
+    EXPECT_EQ(cache.capacity(), cache.size());
+}
+
+TYPED_TEST(PolicyTest, printed_elements_are_resident)
+{
+    auto & cache = this->cache;
+    for (std::size_t i = 0; i < 20; ++i) {
+        cache.template get<String>(number(i));
+    }
+    std::ostringstream strm;
+    cache.print(strm);
+    std::size_t printed = 0;
+    for (std::size_t i = 0; i < 20; ++i) {
+        if (strm.str().find("(" + number(i) + " ") != std::string::npos) {
+            EXPECT_NE(nullptr, cache.template find<String>(number(i)));
+            ++printed;
+        }
+    }
+    EXPECT_EQ(cache.size(), printed);
+}
+
+TYPED_TEST(PolicyTest, scan_resistance)
+{
+    if constexpr (!TypeParam::scan_resistant) {
+        GTEST_SKIP() << "second chance forgets hot elements during a long scan";
+    }
+    auto & cache = this->cache;
+    for (std::size_t round = 0; round < 3; ++round) {
+        for (std::size_t i = 0; i < 4; ++i) {
+            cache.template get<String>(number(i));
+        }
+    }
+    for (std::size_t i = 0; i < 100; ++i) {
+        cache.template get<String>("scan" + std::to_string(i));
+    }
+    for (std::size_t i = 0; i < 4; ++i) {
+        EXPECT_NE(nullptr, cache.template find<String>(number(i))) << number(i);
+    }
+}
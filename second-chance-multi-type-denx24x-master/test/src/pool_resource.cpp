@@ -0,0 +1,141 @@
+#include "allocator.h"
+#include "cache.h"
+#include "pool.h"
+#include "pool_resource.h"
+
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <initializer_list>
+#include <list>
+#include <map>
+#include <memory_resource>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// upstream resource, that counts the memory it has given away
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+    std::size_t allocated = 0;
+
+private:
+    void * do_allocate(const std::size_t bytes, const std::size_t alignment) override
+    {
+        allocated += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void * ptr, const std::size_t bytes, const std::size_t alignment) override
+    {
+        allocated -= bytes;
+        std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource & other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+struct PmrString
+{
+    std::pmr::string data;
+
+    PmrString(const std::string & key, std::pmr::memory_resource * resource = std::pmr::get_default_resource())
+        : data(key, resource)
+    {
+    }
+
+    bool operator==(std::string_view other) const
+    {
+        return std::string_view(data) == other;
+    }
+
+    friend std::ostream & operator<<(std::ostream & strm, const PmrString & str)
+    {
+        return strm << str.data;
+    }
+};
+
+} // anonymous namespace
+
+TEST(PoolResourceTest, large_requests_go_upstream)
+{
+    PoolAllocator pool(1024, {16, 64, 128});
+    CountingResource upstream;
+    PoolMemoryResource resource(pool, &upstream);
+    {
+        std::pmr::vector<int> values(&resource);
+        for (int i = 0; i < 20; ++i) {
+            values.push_back(i);
+        }
+        EXPECT_TRUE(pool.owns(values.data()));
+        EXPECT_EQ(0, upstream.allocated);
+        values.resize(1000);
+        EXPECT_FALSE(pool.owns(values.data()));
+        EXPECT_EQ(1000 * sizeof(int), upstream.allocated);
+    }
+    EXPECT_EQ(0, upstream.allocated);
+    EXPECT_TRUE(resource.is_equal(resource));
+    PoolMemoryResource other(pool, &upstream);
+    EXPECT_FALSE(resource.is_equal(other));
+}
+
+TEST(PoolResourceTest, slots_are_returned)
+{
+    PoolAllocator pool(64, {16});
+    CountingResource upstream;
+    PoolMemoryResource resource(pool, &upstream);
+    std::vector<void *> slots;
+    for (int i = 0; i < 4; ++i) {
+        slots.push_back(resource.allocate(16, 8));
+        EXPECT_TRUE(pool.owns(slots.back()));
+    }
+    void * extra = resource.allocate(16, 8);
+    EXPECT_FALSE(pool.owns(extra));
+    resource.deallocate(extra, 16, 8);
+    resource.deallocate(slots[2], 16, 8);
+    EXPECT_EQ(slots[2], resource.allocate(16, 8));
+    for (void * slot : slots) {
+        resource.deallocate(slot, 16, 8);
+    }
+    EXPECT_EQ(0, upstream.allocated);
+}
+
+TEST(PoolResourceTest, std_allocator)
+{
+    PoolAllocator pool(1024, {16, 64, 128});
+    CountingResource upstream;
+    PoolMemoryResource resource(pool, &upstream);
+    std::vector<long, PoolStdAllocator<long>> values(PoolStdAllocator<long>{resource});
+    values.resize(4);
+    EXPECT_TRUE(pool.owns(values.data()));
+    std::list<int, PoolStdAllocator<int>> list(PoolStdAllocator<int>{resource});
+    list.push_back(1);
+    list.push_back(2);
+    EXPECT_TRUE(pool.owns(&list.front()));
+    std::map<int, int, std::less<int>, PoolStdAllocator<std::pair<const int, int>>> map(PoolStdAllocator<std::pair<const int, int>>{resource});
+    map[1] = 2;
+    EXPECT_TRUE(pool.owns(&*map.begin()));
+    EXPECT_EQ(0, upstream.allocated);
+    EXPECT_TRUE(PoolStdAllocator<int>{resource} == PoolStdAllocator<long>{resource});
+}
+
+TEST(PoolResourceTest, element_buffers)
+{
+    Cache<std::string, PmrString, AllocatorWithPool> cache(2, 4096, std::initializer_list<std::size_t>{sizeof(PmrString), 64});
+    const std::string keys[] = {"a very long key that does not fit into sso buffer", "b", "another quite long key to be put in the pool!!", "c"};
+    for (const auto & key : keys) {
+        EXPECT_EQ(key, std::string_view(cache.emplace<PmrString>(key, key, cache.allocator().resource()).data));
+    }
+    std::ostringstream strm;
+    strm << cache;
+    EXPECT_EQ("(c 0) (another quite long key to be put in the pool!! 0)\n", strm.str());
+}
@@ -0,0 +1,76 @@
+#include "allocator.h"
+#include "cache.h"
+#include "pool.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <new>
+#include <sstream>
+#include <string>
+#include <system_error>
+
+namespace {
+
+bool aligned(const void * ptr, const std::size_t alignment)
+{
+    return reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0;
+}
+
+class PoolStorageTest : public ::testing::TestWithParam<PoolStorage::Pages>
+{
+};
+
+} // anonymous namespace
+
+TEST_P(PoolStorageTest, slots_are_aligned_and_bounded)
+{
+    PoolAllocator pool(100, {3, 32, 8}, PoolStorage{GetParam(), -1});
+    void * small = pool.allocate(3);
+    void * large = pool.allocate(32);
+    void * middle = pool.allocate(8);
+    EXPECT_TRUE(aligned(large, 32));
+    EXPECT_TRUE(aligned(middle, 8));
+    EXPECT_TRUE(pool.owns(small) && pool.owns(large) && pool.owns(middle));
+    pool.deallocate(small);
+    pool.deallocate(large);
+    pool.deallocate(middle);
+    // 100 bytes hold 3 slots of 32
+    for (int i = 0; i < 3; ++i) {
+        std::memset(pool.allocate(32), 1, 32);
+    }
+    EXPECT_THROW(pool.allocate(32), std::bad_alloc);
+    EXPECT_EQ(nullptr, pool.try_allocate(32));
+    // memory of other size classes is still there and zeroed
+    auto * bytes = static_cast<unsigned char *>(pool.allocate(3));
+    EXPECT_EQ(0, bytes[0] | bytes[1] | bytes[2]);
+}
+
+TEST_P(PoolStorageTest, numa_node)
+{
+    PoolAllocator pool(100, {8}, PoolStorage{GetParam(), 0});
+    EXPECT_NE(nullptr, pool.allocate(8));
+    EXPECT_THROW(PoolAllocator(100, {8}, PoolStorage{GetParam(), 1000}), std::system_error);
+}
+
+TEST_P(PoolStorageTest, cache)
+{
+    Cache<std::string, std::string, AllocatorWithPool> cache(3, 1 << 20, std::initializer_list<std::size_t>{sizeof(std::string)}, PoolStorage{GetParam(), -1});
+    for (const auto key : {"a", "b", "c", "d"}) {
+        cache.get<std::string>(key);
+    }
+    std::ostringstream strm;
+    strm << cache;
+    EXPECT_EQ("(d 0) (c 0) (b 0)\n", strm.str());
+}
+
+INSTANTIATE_TEST_SUITE_P(Pages, PoolStorageTest, ::testing::Values(PoolStorage::Pages::Regular, PoolStorage::Pages::Transparent, PoolStorage::Pages::Huge));
+
+TEST(PoolTest, empty_pool)
+{
+    PoolAllocator pool(0, {});
+    EXPECT_THROW(pool.allocate(1), std::bad_alloc);
+    EXPECT_EQ(nullptr, pool.try_allocate(1));
+}
@@ -0,0 +1,91 @@
+#include "allocator.h"
+#include "elements.h"
+#include "sharded_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using TestCache = ShardedCache<std::string, String, AllocatorWithPool>;
+
+TestCache make_cache(const std::size_t size, const std::size_t shards)
+{
+    return TestCache(size, shards, size * sizeof(String), std::initializer_list<std::size_t>{sizeof(String)});
+}
+
+} // anonymous namespace
+
+TEST(ShardedCacheTest, splits_capacity)
+{
+    const auto cache = make_cache(10, 4);
+    EXPECT_EQ(4, cache.shards_count());
+    const auto split = cache.capacity_split();
+    EXPECT_EQ((std::vector<std::size_t>{3, 3, 2, 2}), split);
+    EXPECT_EQ(10, std::accumulate(split.begin(), split.end(), std::size_t{0}));
+    EXPECT_TRUE(cache.empty());
+}
+
+TEST(ShardedCacheTest, more_shards_than_elements)
+{
+    const auto cache = make_cache(3, 8);
+    EXPECT_EQ(3, cache.shards_count());
+    EXPECT_EQ((std::vector<std::size_t>{1, 1, 1}), cache.capacity_split());
+}
+
+TEST(ShardedCacheTest, returns_same_element)
+{
+    auto cache = make_cache(8, 2);
+    cache.get<String>(std::string("a"), [](String & str) {
+        str.marked = true;
+    });
+    EXPECT_TRUE(cache.get<String>(std::string("a"), [](String & str) {
+        return str.marked;
+    }));
+    EXPECT_FALSE(cache.get<String>(std::string("b"), [](String & str) {
+        return str.marked;
+    }));
+    EXPECT_EQ(2, cache.size());
+}
+
+TEST(ShardedCacheTest, size_is_bounded)
+{
+    auto cache = make_cache(10, 4);
+    for (int i = 0; i < 100; i++) {
+        const std::string key = std::to_string(i);
+        EXPECT_EQ(key, cache.get<String>(key, [](String & str) {
+            return str.data;
+        }));
+    }
+    EXPECT_LE(cache.size(), 10);
+    std::ostringstream strm;
+    strm << cache;
+    EXPECT_NE(std::string::npos, strm.str().find("shard 3: "));
+}
+
+TEST(ShardedCacheTest, concurrent_get)
+{
+    auto cache = make_cache(16, 4);
+    std::vector<std::thread> threads;
+    std::vector<std::size_t> mismatches(4);
+    for (std::size_t t = 0; t < 4; t++) {
+        threads.emplace_back([&cache, &mismatches, t] {
+            for (std::size_t i = 0; i < 20000; i++) {
+                const std::string key = std::to_string((i * 7 + t) % 37);
+                if (!cache.get<String>(key, [&key](String & str) { return str.data == key; })) {
+                    mismatches[t]++;
+                }
+            }
+        });
+    }
+    for (auto & thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ((std::vector<std::size_t>(4)), mismatches);
+    EXPECT_LE(cache.size(), 16);
+}
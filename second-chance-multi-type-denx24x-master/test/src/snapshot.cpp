@@ -0,0 +1,168 @@
+#include "allocator.h"
+#include "arc_policy.h"
+#include "cache.h"
+#include "elements.h"
+#include "s3fifo_policy.h"
+#include "snapshot.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <fstream>
+#include <initializer_list>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+struct Number : String
+{
+    int value = 0;
+
+    Number(const std::string & key, const int number = 0)
+        : String(key)
+        , value(number)
+    {
+    }
+};
+
+struct Pod
+{
+    int a;
+    double b;
+};
+
+template <class C>
+std::string print(const C & cache)
+{
+    std::ostringstream strm;
+    strm << cache;
+    return strm.str();
+}
+
+std::string temp_path(const std::string & name)
+{
+    return ::testing::TempDir() + name;
+}
+
+template <template <class> class P>
+using TestCache = Cache<std::string, String, AllocatorWithPool, P>;
+
+template <template <class> class P = SecondChancePolicy>
+TestCache<P> make_cache(const std::size_t size)
+{
+    return TestCache<P>(size, 10 * sizeof(Number), std::initializer_list<std::size_t>{sizeof(String), sizeof(Number)});
+}
+
+} // anonymous namespace
+
+template <>
+struct Serializer<Number>
+{
+    static void write(std::ostream & strm, const Number & number)
+    {
+        Serializer<std::string>::write(strm, number.data);
+        Serializer<int>::write(strm, number.value);
+    }
+
+    static Number read(std::istream & strm)
+    {
+        auto key = Serializer<std::string>::read(strm);
+        return Number(key, Serializer<int>::read(strm));
+    }
+};
+
+static_assert(has_serializer_v<Pod> && has_serializer_v<Number> && has_serializer_v<std::string> && !has_serializer_v<String>);
+
+TEST(SnapshotTest, serializer_round_trip)
+{
+    std::stringstream strm;
+    Serializer<Pod>::write(strm, {1, 2.5});
+    Serializer<std::string>::write(strm, "");
+    Serializer<std::string>::write(strm, std::string("a\0b", 3));
+    Serializer<Number>::write(strm, Number("n", 42));
+    const Pod pod = Serializer<Pod>::read(strm);
+    EXPECT_EQ(1, pod.a);
+    EXPECT_EQ(2.5, pod.b);
+    EXPECT_EQ("", Serializer<std::string>::read(strm));
+    EXPECT_EQ(std::string("a\0b", 3), Serializer<std::string>::read(strm));
+    const Number number = Serializer<Number>::read(strm);
+    EXPECT_EQ("n", number.data);
+    EXPECT_EQ(42, number.value);
+}
+
+TEST(SnapshotTest, dump_and_warm)
+{
+    const auto path = temp_path("cache_dump");
+    auto cache = make_cache(5);
+    for (const auto key : {"a", "b", "c"}) {
+        cache.get<String>(key);
+    }
+    cache.emplace<Number>("n1", "n1", 42);
+    cache.emplace<Number>("n2", "n2", 7);
+    cache.get<String>("a");
+    cache.dump(path);
+
+    auto warmed = make_cache(5);
+    std::atomic<int> loads{0};
+    EXPECT_EQ(3, warmed.warm<String>(path, [&loads](const std::string & key) {
+        loads++;
+        return String(key);
+    }, 3));
+    EXPECT_EQ(3, loads);
+    // stored elements are read back without loader
+    EXPECT_EQ(2, warmed.warm<Number>(path));
+    EXPECT_EQ("(n2 0) (n1 0) (a 1) (c 0) (b 0)\n", print(warmed));
+    EXPECT_EQ(42, warmed.find<Number>("n1")->value);
+    EXPECT_EQ(7, warmed.find<Number>("n2")->value);
+
+    // the most recently used elements are kept, if there is no room for all
+    auto smaller = make_cache(2);
+    EXPECT_EQ(3, smaller.warm<String>(path));
+    EXPECT_EQ("(a 1) (c 0)\n", print(smaller));
+}
+
+TEST(SnapshotTest, recency_order)
+{
+    const auto path = temp_path("recency_dump");
+    // dump goes from the most recently used element whatever the policy order is
+    const auto check = [&path](auto && cache) {
+        for (const auto key : {"a", "b", "c", "d"}) {
+            cache.template get<String>(key);
+        }
+        for (const auto key : {"a", "c", "b"}) {
+            cache.template get<String>(key);
+        }
+        cache.dump(path);
+        auto warmed = make_cache(4);
+        warmed.template warm<String>(path);
+        EXPECT_EQ("(b 1) (c 1) (a 1) (d 0)\n", print(warmed));
+    };
+    check(make_cache<SecondChancePolicy>(4));
+    check(make_cache<S3FifoPolicy>(4));
+    check(make_cache<ArcPolicy>(4));
+}
+
+TEST(SnapshotTest, errors)
+{
+    auto cache = make_cache(2);
+    const auto garbage = temp_path("not_a_dump");
+    std::ofstream(garbage) << "not a cache dump at all";
+    EXPECT_THROW(cache.warm<String>(garbage), std::runtime_error);
+    EXPECT_THROW(cache.warm<String>(temp_path("missing_dump")), std::runtime_error);
+
+    const auto path = temp_path("loader_dump");
+    for (const auto key : {"a", "b"}) {
+        cache.get<String>(key);
+    }
+    cache.dump(path);
+    auto warmed = make_cache(2);
+    EXPECT_THROW(warmed.warm<String>(path, [](const std::string & key) {
+        if (key == "b") {
+            throw std::runtime_error("loader failed");
+        }
+        return String(key);
+    }), std::runtime_error);
+}
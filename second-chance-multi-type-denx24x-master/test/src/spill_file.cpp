@@ -0,0 +1,182 @@
+#include "allocator.h"
+#include "cache.h"
+#include "s3fifo_policy.h"
+#include "snapshot.h"
+#include "spill_file.h"
+
+#include <gtest/gtest.h>
+
+#include <initializer_list>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace {
+
+struct Base
+{
+    std::string data;
+
+    Base(const std::string & key)
+        : data(key)
+    {
+    }
+
+    virtual ~Base() = default;
+
+    const std::string & key() const
+    {
+        return data;
+    }
+
+    bool operator==(std::string_view other) const
+    {
+        return data == other;
+    }
+
+    friend std::ostream & operator<<(std::ostream & strm, const Base & base)
+    {
+        return strm << base.data;
+    }
+};
+
+struct Number : Base
+{
+    long value = 0;
+
+    Number(const std::string & key, const long number = 0)
+        : Base(key)
+        , value(number)
+    {
+    }
+};
+
+struct Text : Base
+{
+    using Base::Base;
+};
+
+std::string temp_path(const std::string & name)
+{
+    return ::testing::TempDir() + name;
+}
+
+} // anonymous namespace
+
+template <>
+struct Serializer<Number>
+{
+    static void write(std::ostream & strm, const Number & number)
+    {
+        Serializer<std::string>::write(strm, number.data);
+        Serializer<long>::write(strm, number.value);
+    }
+
+    static Number read(std::istream & strm)
+    {
+        auto key = Serializer<std::string>::read(strm);
+        return Number(key, Serializer<long>::read(strm));
+    }
+};
+
+template <>
+struct Serializer<Text>
+{
+    static void write(std::ostream & strm, const Text & text)
+    {
+        Serializer<std::string>::write(strm, text.data);
+    }
+
+    static Text read(std::istream & strm)
+    {
+        return Text(Serializer<std::string>::read(strm));
+    }
+};
+
+TEST(SpillFileTest, put_find_erase)
+{
+    SpillFile file(temp_path("spill_basic"), 4096);
+    EXPECT_EQ(4096, file.capacity());
+    file.put(1, "a", "first");
+    // records with the same hash are told apart by key
+    file.put(1, "b", "second");
+    EXPECT_EQ("first", file.find(1, "a"));
+    EXPECT_EQ("second", file.find(1, "b"));
+    EXPECT_FALSE(file.find(2, "a"));
+    file.put(1, "a", "replaced");
+    EXPECT_EQ("replaced", file.find(1, "a"));
+    EXPECT_EQ(2, file.size());
+    file.erase(1, "a");
+    EXPECT_FALSE(file.find(1, "a"));
+    EXPECT_EQ("second", file.find(1, "b"));
+    EXPECT_EQ(1, file.size());
+}
+
+TEST(SpillFileTest, compaction_drops_oldest_records)
+{
+    SpillFile file(temp_path("spill_compaction"), 256);
+    for (int i = 0; i < 1000; ++i) {
+        file.put(i % 7, "key" + std::to_string(i % 7), std::string(i % 50, static_cast<char>('a' + i % 26)));
+    }
+    // only the three latest records fit
+    EXPECT_EQ(3, file.size());
+    for (int i = 0; i < 7; ++i) {
+        const auto value = file.find(i, "key" + std::to_string(i));
+        if (i >= 3 && i <= 5) {
+            ASSERT_TRUE(value);
+            EXPECT_EQ(std::string(44 + i, static_cast<char>('a' + (994 + i) % 26)), *value);
+        }
+        else {
+            EXPECT_FALSE(value);
+        }
+    }
+}
+
+TEST(SpillFileTest, oversized_record_is_dropped)
+{
+    SpillFile file(temp_path("spill_oversized"), 256);
+    file.put(1, "huge", "small");
+    file.put(1, "huge", std::string(1000, 'x'));
+    EXPECT_FALSE(file.find(1, "huge"));
+    EXPECT_EQ(0, file.size());
+}
+
+TEST(SpillFileTest, bad_path)
+{
+    EXPECT_THROW(SpillFile(temp_path("no_such_dir/spill"), 256), std::runtime_error);
+}
+
+TEST(SpillFileTest, cache_round_trip)
+{
+    Cache<std::string, Base, AllocatorWithPool, S3FifoPolicy> cache(4, 10 * sizeof(Number), std::initializer_list<std::size_t>{sizeof(Number)});
+    cache.set_spill_file(temp_path("spill_cache"), 4000);
+    for (long i = 0; i < 20; ++i) {
+        cache.emplace<Number>("k" + std::to_string(i), "k" + std::to_string(i), i * 10);
+    }
+    EXPECT_EQ(4, cache.size());
+    for (long i = 0; i < 20; ++i) {
+        const Number * number = cache.find<Number>(std::string_view("k" + std::to_string(i)));
+        ASSERT_NE(nullptr, number);
+        EXPECT_EQ(i * 10, number->value);
+    }
+    EXPECT_EQ(20, cache.stats().total.spill_hits);
+    for (long i = 0; i < 20; ++i) {
+        EXPECT_EQ(i * 10, cache.get<Number>("k" + std::to_string(i)).value);
+    }
+    // every element was restored from the file
+    EXPECT_EQ(40, cache.stats().total.spill_hits);
+}
+
+TEST(SpillFileTest, record_of_other_type_is_dropped)
+{
+    Cache<std::string, Base, AllocatorWithPool> cache(1, 10 * sizeof(Number), std::initializer_list<std::size_t>{sizeof(Number)});
+    cache.set_spill_file(temp_path("spill_types"), 4000);
+    cache.emplace<Number>("a", "a", 5);
+    cache.emplace<Number>("b", "b", 6);
+    EXPECT_EQ(nullptr, cache.find<Text>(std::string("a")));
+    EXPECT_EQ(nullptr, cache.find<Number>(std::string("a")));
+    const Number * number = cache.find<Number>(std::string("b"));
+    ASSERT_NE(nullptr, number);
+    EXPECT_EQ(6, number->value);
+}
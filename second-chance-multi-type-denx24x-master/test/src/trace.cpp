@@ -0,0 +1,75 @@
+#include "trace.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string write_file(const std::string & name, const std::string & content)
+{
+    const std::string path = ::testing::TempDir() + name;
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << content;
+    return path;
+}
+
+} // anonymous namespace
+
+TEST(TraceTest, text_trace_skips_empty_lines)
+{
+    const MappedFile file(write_file("text_trace", "a\n\nbb\nccc"));
+    EXPECT_EQ(9, file.size());
+    EXPECT_EQ((std::vector<std::string_view>{"a", "bb", "ccc"}), TextTrace(file));
+}
+
+TEST(TraceTest, empty_file)
+{
+    const MappedFile file(write_file("empty_trace", ""));
+    EXPECT_EQ(0, file.size());
+    EXPECT_TRUE(TextTrace(file).empty());
+    EXPECT_EQ(0, BinaryTrace(file).size);
+}
+
+TEST(TraceTest, binary_trace)
+{
+    const std::vector<std::uint64_t> keys = {1, 1ULL << 40, 7};
+    const MappedFile file(write_file("binary_trace", std::string(reinterpret_cast<const char *>(keys.data()), keys.size() * sizeof(std::uint64_t))));
+    const auto span = BinaryTrace(file);
+    EXPECT_EQ(keys, std::vector<std::uint64_t>(span.begin(), span.end()));
+    const MappedFile truncated(write_file("truncated_trace", "1234567"));
+    EXPECT_THROW(BinaryTrace(truncated), std::runtime_error);
+}
+
+TEST(TraceTest, missing_file)
+{
+    EXPECT_THROW(MappedFile(::testing::TempDir() + "no_such_trace"), std::runtime_error);
+}
+
+TEST(TraceTest, zipf_trace)
+{
+    const auto trace = ZipfTrace(100, 10000, 1.0, 5);
+    EXPECT_EQ(10000, trace.size());
+    EXPECT_EQ(trace, ZipfTrace(100, 10000, 1.0, 5));
+    EXPECT_NE(trace, ZipfTrace(100, 10000, 1.0, 6));
+    EXPECT_LT(*std::max_element(trace.begin(), trace.end()), 100);
+    // the first rank is the most popular one
+    std::vector<std::size_t> counts(100);
+    for (const auto key : trace) {
+        counts[key]++;
+    }
+    EXPECT_EQ(counts.begin(), std::max_element(counts.begin(), counts.end()));
+    EXPECT_GT(counts[0], counts[99] * 10);
+    EXPECT_THROW(ZipfTrace(0, 1, 1.0), std::invalid_argument);
+}
+
+TEST(TraceTest, scan_and_loop_traces)
+{
+    EXPECT_EQ((std::vector<std::uint64_t>{0, 1, 2, 3}), ScanTrace(4));
+    EXPECT_EQ((std::vector<std::uint64_t>{0, 1, 2, 0, 1}), LoopTrace(3, 5));
+    EXPECT_THROW(LoopTrace(0, 1), std::invalid_argument);
+}